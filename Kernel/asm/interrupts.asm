@@ -1,6 +1,8 @@
 
 GLOBAL _cli
 GLOBAL _sti
+GLOBAL _cli_save
+GLOBAL _restore_interrupts
 GLOBAL _hlt
 GLOBAL _force_timer_interrupt
 GLOBAL forced_timer_int
@@ -133,6 +135,19 @@ _sti:
 	sti
 	ret
 
+; returns RFLAGS before disabling interrupts
+_cli_save:
+	pushfq
+	pop rax
+	cli
+	ret
+
+; puts back the RFLAGS _cli_save returned, interrupts included
+_restore_interrupts:
+	push rdi
+	popfq
+	ret
+
 _force_timer_interrupt:
 	mov BYTE [forced_timer_int], 0x01
 	int 0x20
@@ -15,11 +15,13 @@ GLOBAL stackInit
 GLOBAL processExit
 GLOBAL semLock
 GLOBAL semUnlock
+GLOBAL semTryLock
+GLOBAL _rdtsc
+GLOBAL _outb
 
 EXTERN register_snapshot
 EXTERN register_snapshot_taken
-EXTERN kill
-EXTERN getCurrentProcess
+EXTERN exitCurrentProcess
 
 
 
@@ -183,13 +185,9 @@ stackInit:
 
 
 processExit:
-	; Get current process PID and kill it
-	call getCurrentProcess
-	test rax, rax
-	jz .hang              ; If no current process, hang
-	
-	mov rdi, [rax]        ; Get PID (first field in Process struct)
-	call kill             ; Call kill(current_pid)
+	; The entry function returned here with its exit status in rax
+	mov rdi, rax
+	call exitCurrentProcess
 	
 	; Force a scheduler interrupt by calling yield
 	int 0x20              ; Timer interrupt to force scheduler
@@ -210,3 +208,24 @@ semLock:
 semUnlock:
     mov BYTE [rdi], 0
     ret
+
+; one attempt at the lock, returns 0 when it was taken
+semTryLock:
+    mov al, 1
+    xchg al, BYTE [rdi]
+    movzx eax, al
+    ret
+
+; returns the 64-bit timestamp counter (edx:eax joined in rax)
+_rdtsc:
+    rdtsc
+    shl rdx, 32
+    or rax, rdx
+    ret
+
+; writes the byte in sil to the port in di
+_outb:
+    mov dx, di
+    mov al, sil
+    out dx, al
+    ret
@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <process.h>
 #include <semaphore.h>
+#include <lockStats.h>
 
 #define BUFFER_SIZE 1024
 
@@ -40,7 +41,8 @@
 semADT semKey = NULL;
 
 void initKeySem(){
-    semKey = semInit("keyb", 0);
+    semKey = semCreate(0);
+    lockStatsName(semKey, LOCK_KIND_SEMAPHORE, "keyboard");
 }
 
 static uint8_t SHIFT_KEY_PRESSED, CAPS_LOCK_KEY_PRESSED, CONTROL_KEY_PRESSED;
@@ -67,27 +67,68 @@ int32_t syscallDispatcher(Registers * registers) {
 		case 0x80000100: return (int64_t) sys_malloc(registers->rdi);
 		case 0x80000101: return sys_free((void *) registers->rdi);
 		case 0x80000102: return sys_memstats((int *) registers->rdi, (int *) registers->rsi, (int *) registers->rdx);
+		case 0x80000103: return sys_memstats_pid((int) registers->rdi);
+		case 0x80000104: return sys_memstats_extended((MemoryStats *) registers->rdi);
+		case 0x80000105: return (int64_t) sys_realloc((void *) registers->rdi, (int) registers->rsi);
+		case 0x80000106: return (int64_t) sys_calloc((int) registers->rdi, (int) registers->rsi);
+		case 0x80000107: return (int64_t) sys_aligned_alloc((int) registers->rdi, (int) registers->rsi);
+		case 0x80000108: return sys_stack_cache_stats((StackCacheStats *) registers->rdi);
 
 		case 0x80000200: return sys_getpid();
-		case 0x80000201: return sys_create_process((uint8_t *) registers->rdi, registers->rsi, (char **) registers->rdx, (uint8_t) registers->rcx);
+		case 0x80000201: return sys_create_process((uint8_t *) registers->rdi, registers->rsi, (char **) registers->rdx, (uint8_t) registers->rcx, (int) registers->r8);
 		case 0x80000202: return sys_unblock((int) registers->rdi);
 		case 0x80000203: return sys_block((int) registers->rdi);
 		case 0x80000204: return sys_kill((int) registers->rdi);
-		case 0x80000205: return sys_ps((ProcessInformation *) registers->rdi);
+		case 0x80000205: return sys_ps((ProcessInformation *) registers->rdi, (int) registers->rsi);
 		case 0x80000206: return sys_nice((int) registers->rdi, (int) registers->rsi);
-		case 0x80000207: return sys_wait_pid((int) registers->rdi);
+		case 0x80000207: return sys_wait_pid((int) registers->rdi, (int *) registers->rsi);
 		case 0x80000208: return sys_yield();
 		case 0x80000209: return sys_wait_children();
 		case 0x8000020A: return sys_get_process_info((int) registers->rdi, (ProcessInformation *) registers->rsi);
+		case 0x8000020B: return sys_thread_create((void *) registers->rdi, (void *) registers->rsi, (int) registers->rdx);
+		case 0x8000020C: return sys_thread_join((int) registers->rdi);
+		case 0x8000020D: return sys_spawn((void *) registers->rdi, (int) registers->rsi, (char **) registers->rdx, (const SpawnAttributes *) registers->rcx);
+		case 0x8000020E: return sys_spawn_batch((const SpawnRequest *) registers->rdi, (int) registers->rsi, (int32_t *) registers->rdx);
+		case 0x8000020F: return sys_wait_any((int *) registers->rdi);
+		case 0x80000210: return sys_process_snapshot((uint64_t) registers->rdi, (ProcessInformation *) registers->rsi, (int) registers->rdx, (ProcessSnapshot *) registers->rcx);
+		case 0x80000211: return sys_set_resource_limit((int) registers->rdi, (ResourceType) registers->rsi, (int) registers->rdx);
+		case 0x80000212: return sys_get_resource_usage((int) registers->rdi, (ResourceUsage *) registers->rsi);
 
 		case 0x80000300: return (int64_t)sys_sem_init((const char *) registers->rdi, (uint32_t) registers->rsi);
 		case 0x80000301: return sys_sem_post((semADT) registers->rdi);
 		case 0x80000302: return sys_sem_wait((semADT) registers->rdi);
 		case 0x80000303: return sys_sem_destroy((semADT) registers->rdi);
+		case 0x80000304: return sys_futex_wait((int32_t *) registers->rdi, (int32_t) registers->rsi);
+		case 0x80000305: return sys_futex_wake((int32_t *) registers->rdi, (int) registers->rsi);
+		case 0x80000306: return (int64_t)sys_mutex_create((uint8_t) registers->rdi);
+		case 0x80000307: return sys_mutex_lock((mutexADT) registers->rdi);
+		case 0x80000308: return sys_mutex_trylock((mutexADT) registers->rdi);
+		case 0x80000309: return sys_mutex_unlock((mutexADT) registers->rdi);
+		case 0x8000030A: return sys_mutex_destroy((mutexADT) registers->rdi);
+		case 0x8000030B: return (int64_t)sys_cond_create();
+		case 0x8000030C: return sys_cond_wait((condADT) registers->rdi, (mutexADT) registers->rsi);
+		case 0x8000030D: return sys_cond_signal((condADT) registers->rdi);
+		case 0x8000030E: return sys_cond_broadcast((condADT) registers->rdi);
+		case 0x8000030F: return sys_cond_destroy((condADT) registers->rdi);
+		case 0x80000310: return (int64_t)sys_rwlock_create();
+		case 0x80000311: return sys_rwlock_read_lock((rwlockADT) registers->rdi);
+		case 0x80000312: return sys_rwlock_write_lock((rwlockADT) registers->rdi);
+		case 0x80000313: return sys_rwlock_unlock((rwlockADT) registers->rdi);
+		case 0x80000314: return sys_rwlock_destroy((rwlockADT) registers->rdi);
+		case 0x80000315: return (int64_t)sys_barrier_create((int) registers->rdi);
+		case 0x80000316: return sys_barrier_wait((barrierADT) registers->rdi);
+		case 0x80000317: return sys_barrier_destroy((barrierADT) registers->rdi);
+		case 0x80000318: return (int64_t)sys_latch_create((int) registers->rdi);
+		case 0x80000319: return sys_latch_count_down((latchADT) registers->rdi, (int) registers->rsi);
+		case 0x8000031A: return sys_latch_wait((latchADT) registers->rdi);
+		case 0x8000031B: return sys_latch_destroy((latchADT) registers->rdi);
+		case 0x8000031C: return sys_lock_stats((LockStatsEntry *) registers->rdi, (int) registers->rsi);
 		
 		case 0x80000400: return sys_pipe((int *) registers->rdi);
 		case 0x80000401: return sys_close_pipe((int) registers->rdi);
 		case 0x80000402: return sys_set_fd_target((int) registers->rdi, (PipeEndpointType) registers->rsi, (int) registers->rdx);
+		case 0x80000403: return sys_vmsplice((int32_t) registers->rdi, (const char *) registers->rsi, (int32_t) registers->rdx);
+		case 0x80000404: return sys_splice((int32_t) registers->rdi, (int32_t) registers->rsi, (int32_t) registers->rdx);
 		
 		default:
             return 0;
@@ -115,7 +156,7 @@ int32_t sys_write(int32_t fd, char * __user_buf, int32_t count) {
         return -1;
     }
 
-    Process *current = getCurrentProcess();
+    Process *current = processGroupLeader(getCurrentProcess());
     if (current == NULL) {
         return -1;
     }
@@ -145,7 +186,7 @@ int32_t sys_read(int32_t fd, signed char * __user_buf, int32_t count) {
         return -1;
     }
 
-    Process *current = getCurrentProcess();
+    Process *current = processGroupLeader(getCurrentProcess());
     if (current == NULL) {
         return -1;
     }
@@ -172,7 +213,8 @@ int32_t sys_pipe(int pipefd[2]) {
         return -1;
     }
 
-    int pipeID = openPipe();
+    Process *current = processGroupLeader(getCurrentProcess());
+    int pipeID = openPipe(current == NULL ? -1 : current->pid);
     if (pipeID < 0) {
         return -1;
     }
@@ -194,7 +236,7 @@ int32_t sys_set_fd_target(int fd, PipeEndpointType type, int pipeID) {
         return -1;
     }
 
-    Process *current = getCurrentProcess();
+    Process *current = processGroupLeader(getCurrentProcess());
     if (current == NULL) {
         return -1;
     }
@@ -208,6 +250,60 @@ int32_t sys_set_fd_target(int fd, PipeEndpointType type, int pipeID) {
     return status;
 }
 
+int32_t sys_vmsplice(int32_t fd, const char * buf, int32_t count) {
+    if (buf == NULL || count < 0 || (fd != FD_STDOUT && fd != FD_STDERR)) {
+        return -1;
+    }
+
+    Process *current = processGroupLeader(getCurrentProcess());
+    if (current == NULL) {
+        return -1;
+    }
+
+    // The console has nothing to lend to, it draws straight from the buffer anyway
+    PipeEndpoint *endpoint = &current->fds[WRITE_FD];
+    if (endpoint->type == PIPE_ENDPOINT_CONSOLE) {
+        return printToFd(fd, buf, count);
+    }
+
+    if (endpoint->type == PIPE_ENDPOINT_PIPE) {
+        return vmsplicePipe(endpoint->pipeID, (const uint8_t *)buf, count);
+    }
+
+    return -1;
+}
+
+static int consoleSink(void * context, const uint8_t * data, int size) {
+    return printToFd(*(int32_t *)context, (const char *)data, size);
+}
+
+int32_t sys_splice(int32_t fdIn, int32_t fdOut, int32_t count) {
+    if (count < 0 || fdIn != FD_STDIN || (fdOut != FD_STDOUT && fdOut != FD_STDERR)) {
+        return -1;
+    }
+
+    Process *current = processGroupLeader(getCurrentProcess());
+    if (current == NULL) {
+        return -1;
+    }
+
+    PipeEndpoint *in = &current->fds[READ_FD];
+    PipeEndpoint *out = &current->fds[WRITE_FD];
+    if (in->type != PIPE_ENDPOINT_PIPE) {
+        return -1;
+    }
+
+    if (out->type == PIPE_ENDPOINT_CONSOLE) {
+        return splicePipe(in->pipeID, consoleSink, &fdOut, count);
+    }
+
+    if (out->type == PIPE_ENDPOINT_PIPE) {
+        return splicePipes(in->pipeID, out->pipeID, count);
+    }
+
+    return -1;
+}
+
 // ==================================================================
 // Custom system calls
 // ==================================================================
@@ -371,15 +467,81 @@ int32_t sys_get_character_without_display(void) {
 // Memory management system calls
 // ==================================================================
 
+// Blocks are charged to their owner with the size the allocator actually reserved
+static void * chargeHeapBlock(void * ptr, int owner) {
+	resourceAdd(owner, RESOURCE_HEAP, memstatsBlock(ptr, NULL));
+	return ptr;
+}
+
 void * sys_malloc(int size) {
-	return myMalloc(size);
+	Process * currentProcess = processGroupLeader(getCurrentProcess());
+	int owner = (currentProcess == NULL) ? MEMORY_KERNEL_OWNER : currentProcess->pid;
+	if (resourceCheck(owner, RESOURCE_HEAP, size) != 0) {
+		return NULL;
+	}
+	void * ptr = myMallocOwned(size, owner);
+	if (ptr == NULL && stackCacheFlush() > 0) {
+		ptr = myMallocOwned(size, owner);
+	}
+	return chargeHeapBlock(ptr, owner);
+}
+
+void * sys_realloc(void * ptr, int size) {
+	if (ptr == NULL) {
+		return sys_malloc(size);
+	}
+	int owner = MEMORY_KERNEL_OWNER;
+	int reserved = memstatsBlock(ptr, &owner);
+	if (reserved == 0) {
+		return NULL;
+	}
+	if (resourceCheck(owner, RESOURCE_HEAP, size - reserved) != 0) {
+		return NULL;
+	}
+	void * resized = myRealloc(ptr, size);
+	if (resized == NULL && size > 0 && stackCacheFlush() > 0) {
+		resized = myRealloc(ptr, size);
+	}
+	if (resized != NULL || size <= 0) {
+		resourceAdd(owner, RESOURCE_HEAP, memstatsBlock(resized, NULL) - reserved);
+	}
+	return resized;
+}
+
+void * sys_calloc(int count, int size) {
+	Process * currentProcess = processGroupLeader(getCurrentProcess());
+	int owner = (currentProcess == NULL) ? MEMORY_KERNEL_OWNER : currentProcess->pid;
+	if (count > 0 && size > 0 && resourceCheck(owner, RESOURCE_HEAP, count * size) != 0) {
+		return NULL;
+	}
+	void * ptr = myCallocOwned(count, size, owner);
+	if (ptr == NULL && stackCacheFlush() > 0) {
+		ptr = myCallocOwned(count, size, owner);
+	}
+	return chargeHeapBlock(ptr, owner);
+}
+
+void * sys_aligned_alloc(int alignment, int size) {
+	Process * currentProcess = processGroupLeader(getCurrentProcess());
+	int owner = (currentProcess == NULL) ? MEMORY_KERNEL_OWNER : currentProcess->pid;
+	if (resourceCheck(owner, RESOURCE_HEAP, size) != 0) {
+		return NULL;
+	}
+	void * ptr = myAlignedAllocOwned(alignment, size, owner);
+	if (ptr == NULL && stackCacheFlush() > 0) {
+		ptr = myAlignedAllocOwned(alignment, size, owner);
+	}
+	return chargeHeapBlock(ptr, owner);
 }
 
 int32_t sys_free(void * ptr) {
-	if (!isValidHeapPtr(ptr)) {
+	int owner = MEMORY_KERNEL_OWNER;
+	int reserved = memstatsBlock(ptr, &owner);
+	if (reserved == 0) {
 		return 0;
 	}
 	myFree(ptr);
+	resourceAdd(owner, RESOURCE_HEAP, -reserved);
 	return 1;
 }
 
@@ -388,6 +550,29 @@ int32_t sys_memstats(int * total, int * used, int * available) {
 	return 0;
 }
 
+int32_t sys_memstats_extended(MemoryStats * stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	memstatsExtended(stats);
+	return 0;
+}
+
+int32_t sys_stack_cache_stats(StackCacheStats * stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	stackCacheGetStats(stats);
+	return 0;
+}
+
+int32_t sys_memstats_pid(int pid) {
+	if (getProcess(pid) == NULL) {
+		return -1;
+	}
+	return memstatsOwner(pid);
+}
+
 // ==================================================================
 // Process management system calls
 // ==================================================================
@@ -399,8 +584,8 @@ int32_t sys_getpid(void) {
 	}
 	return currentProcess->pid;
 }
-int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_background) {
-	Process * parent = getCurrentProcess();
+int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_background, int stackSize) {
+	Process * parent = processGroupLeader(getCurrentProcess());
 	int priority = MID_PRIORITY;
 	int parentID = -1;
 
@@ -409,7 +594,7 @@ int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_b
 		parentID = parent->pid;
 	}
 
-	Process * newProcess = createProcess(function, argc, argv, priority, parentID, is_background);
+	Process * newProcess = createProcess(function, argc, argv, priority, parentID, is_background, stackSize);
 	if (newProcess == NULL) {
 		return -1;
 	}
@@ -417,6 +602,34 @@ int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_b
 	return newProcess->pid; // Return the PID of the newly created process
 }
 
+int32_t sys_spawn(void * function, int argc, char ** argv, const SpawnAttributes * attributes) {
+	Process * parent = processGroupLeader(getCurrentProcess());
+	Process * newProcess = spawnProcess(function, argc, argv, (parent == NULL) ? -1 : parent->pid, attributes);
+	if (newProcess == NULL) {
+		return -1;
+	}
+	return newProcess->pid;
+}
+
+// Runs with interrupts off like every syscall, and nothing on the spawn path turns them back on (the
+// foreground helpers restore the caller's flags), so the whole batch becomes runnable at once
+int32_t sys_spawn_batch(const SpawnRequest * requests, int count, int32_t * pids) {
+	Process * parent = processGroupLeader(getCurrentProcess());
+	return spawnBatch(requests, count, (parent == NULL) ? -1 : parent->pid, pids);
+}
+
+int32_t sys_thread_create(void * function, void * arg, int stackSize) {
+	Process * thread = createThread(function, arg, stackSize);
+	if (thread == NULL) {
+		return -1;
+	}
+	return thread->pid;
+}
+
+int32_t sys_thread_join(int tid) {
+	return joinThread(tid);
+}
+
 int32_t sys_unblock(int pid) {
 	return unblock(pid);
 }
@@ -429,8 +642,8 @@ int32_t sys_kill(int pid) {
 	return kill(pid);
 }
 
-int32_t sys_ps(ProcessInformation * processInfoTable) {
-	return ps(processInfoTable);
+int32_t sys_ps(ProcessInformation * processInfoTable, int maxCount) {
+	return ps(processInfoTable, maxCount);
 }
 
 int32_t sys_get_process_info(int pid, ProcessInformation *info) {
@@ -441,8 +654,24 @@ int32_t sys_nice(int pid, int newPriority) {
 	return nice(pid, newPriority);
 }
 
-int32_t sys_wait_pid(int pid) {
-	return waitPid(pid);
+int32_t sys_wait_pid(int pid, int * status) {
+	return waitPid(pid, status);
+}
+
+int32_t sys_wait_any(int * status) {
+	return waitAny(status);
+}
+
+int32_t sys_process_snapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot) {
+	return processSnapshot(since, table, maxCount, snapshot);
+}
+
+int32_t sys_set_resource_limit(int pid, ResourceType type, int limit) {
+	return setResourceLimit(pid, type, limit);
+}
+
+int32_t sys_get_resource_usage(int pid, ResourceUsage * resources) {
+	return getResourceUsage(pid, resources);
 }
 
 int32_t sys_wait_children(void) {
@@ -459,7 +688,8 @@ int32_t sys_yield(void) {
 // ==================================================================
 
 semADT sys_sem_init(const char *name, uint32_t initial_count) {
-	return semInit(name, initial_count);
+	Process * current = processGroupLeader(getCurrentProcess());
+	return semInitOwned(name, initial_count, current == NULL ? -1 : current->pid);
 }
 
 int32_t sys_sem_post(semADT sem) {
@@ -474,4 +704,109 @@ int32_t sys_sem_destroy(semADT sem) {
 	semDestroy(sem);
 	return 0;
 }
+
+int32_t sys_futex_wait(int32_t * addr, int32_t expected) {
+	return futexWait(addr, expected);
+}
+
+int32_t sys_futex_wake(int32_t * addr, int count) {
+	return futexWake(addr, count);
+}
+
+mutexADT sys_mutex_create(uint8_t recursive) {
+	Process * current = processGroupLeader(getCurrentProcess());
+	return mutexCreate(recursive, current == NULL ? -1 : current->pid);
+}
+
+int32_t sys_mutex_lock(mutexADT mutex) {
+	return mutexLock(mutex);
+}
+
+int32_t sys_mutex_trylock(mutexADT mutex) {
+	return mutexTryLock(mutex);
+}
+
+int32_t sys_mutex_unlock(mutexADT mutex) {
+	return mutexUnlock(mutex);
+}
+
+int32_t sys_mutex_destroy(mutexADT mutex) {
+	return mutexDestroy(mutex);
+}
+
+condADT sys_cond_create(void) {
+	Process * current = processGroupLeader(getCurrentProcess());
+	return condCreate(current == NULL ? -1 : current->pid);
+}
+
+int32_t sys_cond_wait(condADT cond, mutexADT mutex) {
+	return condWait(cond, mutex);
+}
+
+int32_t sys_cond_signal(condADT cond) {
+	return condSignal(cond);
+}
+
+int32_t sys_cond_broadcast(condADT cond) {
+	return condBroadcast(cond);
+}
+
+int32_t sys_cond_destroy(condADT cond) {
+	return condDestroy(cond);
+}
+
+rwlockADT sys_rwlock_create(void) {
+	Process * current = processGroupLeader(getCurrentProcess());
+	return rwlockCreate(current == NULL ? -1 : current->pid);
+}
+
+int32_t sys_rwlock_read_lock(rwlockADT lock) {
+	return rwlockReadLock(lock);
+}
+
+int32_t sys_rwlock_write_lock(rwlockADT lock) {
+	return rwlockWriteLock(lock);
+}
+
+int32_t sys_rwlock_unlock(rwlockADT lock) {
+	return rwlockUnlock(lock);
+}
+
+int32_t sys_rwlock_destroy(rwlockADT lock) {
+	return rwlockDestroy(lock);
+}
+
+barrierADT sys_barrier_create(int parties) {
+	Process * current = processGroupLeader(getCurrentProcess());
+	return barrierCreate(parties, current == NULL ? -1 : current->pid);
+}
+
+int32_t sys_barrier_wait(barrierADT barrier) {
+	return barrierWait(barrier);
+}
+
+int32_t sys_barrier_destroy(barrierADT barrier) {
+	return barrierDestroy(barrier);
+}
+
+latchADT sys_latch_create(int count) {
+	Process * current = processGroupLeader(getCurrentProcess());
+	return latchCreate(count, current == NULL ? -1 : current->pid);
+}
+
+int32_t sys_latch_count_down(latchADT latch, int count) {
+	return latchCountDown(latch, count);
+}
+
+int32_t sys_latch_wait(latchADT latch) {
+	return latchWait(latch);
+}
+
+int32_t sys_latch_destroy(latchADT latch) {
+	return latchDestroy(latch);
+}
+
+int32_t sys_lock_stats(LockStatsEntry * table, int maxCount) {
+	return lockStatsSnapshot(table, maxCount);
+}
 // =========================================================
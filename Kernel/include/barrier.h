@@ -0,0 +1,25 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <stdint.h>
+
+typedef struct barrierCDT * barrierADT;
+typedef struct latchCDT * latchADT;
+
+// Reusable barrier for parties processes, the last one to arrive releases the rest in one bulk wake
+barrierADT barrierCreate(int parties, int creatorPid);
+// Returns 1 to the process that completed the round, 0 to the others and -1 for a bad handle
+int barrierWait(barrierADT barrier);
+// Fails with -1 while processes wait on the barrier
+int barrierDestroy(barrierADT barrier);
+
+// One-shot countdown latch, every waiter is released at once when the count reaches zero
+latchADT latchCreate(int count, int creatorPid);
+// Subtracts count, stopping at zero. Returns the count left.
+int latchCountDown(latchADT latch, int count);
+// Returns at once when the count is already zero
+int latchWait(latchADT latch);
+// Fails with -1 while processes wait on the latch
+int latchDestroy(latchADT latch);
+
+#endif
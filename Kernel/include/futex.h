@@ -0,0 +1,14 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <stdint.h>
+
+// Blocks the current process while *addr still holds expected. Returns 0 once woken, 1 when the value had
+// already changed and -1 for a bad address. Relies on running with interrupts off, as every syscall does,
+// so no wake can slip between the check and the block.
+int futexWait(int32_t * addr, int32_t expected);
+
+// Wakes up to count processes waiting on addr, oldest first. Returns how many were woken.
+int futexWake(int32_t * addr, int count);
+
+#endif
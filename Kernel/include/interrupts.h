@@ -19,6 +19,12 @@ void _cli(void);
 
 void _sti(void);
 
+// Disables interrupts and returns the previous flags, for sections that may run inside a syscall (already
+// with interrupts off) and must not turn them on when they end
+uint64_t _cli_save(void);
+
+void _restore_interrupts(uint64_t flags);
+
 void _hlt(void);
 
 void _force_timer_interrupt(void);
@@ -17,6 +17,11 @@ uint8_t getSecond(void);
 uint8_t getMinute(void);
 uint8_t getHour(void);
 
-uint8_t * stackInit(void * rsp, void * rip, int argc, char ** argv);
+uint8_t * stackInit(void * rsp, void * rip, uint64_t argc, char ** argv);
+
+// Reads the CPU timestamp counter
+uint64_t _rdtsc(void);
+// Writes a byte to an I/O port
+void _outb(uint16_t port, uint8_t value);
 
 #endif
\ No newline at end of file
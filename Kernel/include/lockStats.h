@@ -0,0 +1,58 @@
+#ifndef LOCK_STATS_H
+#define LOCK_STATS_H
+
+#include <stdint.h>
+
+// Contention profile of spinlocks and semaphores, only collected in kernels built with LOCK_STATS=1
+
+#define LOCK_STATS_MAX 64
+#define LOCK_STATS_NAME_LENGTH 16
+
+typedef enum {
+    LOCK_KIND_SPINLOCK = 0,
+    LOCK_KIND_SEMAPHORE,
+} LockKind;
+
+typedef struct LockStatsEntry {
+    uint64_t address;           // Lock byte or semaphore handle, 0 once the object was freed
+    char name[LOCK_STATS_NAME_LENGTH];
+    uint8_t kind;
+    int holderPid;              // Last process that got past the lock without releasing it, -1 if none
+    uint64_t acquisitions;
+    uint64_t contended;         // Acquisitions that had to spin or block
+    uint64_t spins;             // Failed attempts on a spinlock
+    uint64_t waitCycles;        // TSC cycles spent getting the lock
+    uint64_t maxWaitCycles;
+} LockStatsEntry;
+
+// Copies up to maxCount entries sorted by total wait, longest first. Returns how many, -1 when the
+// kernel was built without LOCK_STATS.
+int lockStatsSnapshot(LockStatsEntry * table, int maxCount);
+
+#ifdef LOCK_STATS
+#include "lib.h"
+
+// Timestamp a semaphore wait starts at
+#define lockStatsStart() _rdtsc()
+// Labels an object for the dump, unnamed spinlocks show up by address only
+void lockStatsName(const void * object, LockKind kind, const char * name);
+// Detaches the entry from an object about to be freed, its numbers stay in the dump
+void lockStatsForget(const void * object);
+void lockStatsSpinLock(uint8_t * lock);
+void lockStatsSpinUnlock(uint8_t * lock);
+// Counts a wait on sem before it may sleep, blocked is 1 when it will. Returns the entry to hand to
+// lockStatsSemWaited, since sem itself can be freed during the sleep.
+LockStatsEntry * lockStatsSemWaiting(const void * sem, const char * name, int blocked);
+// Adds the cycles since startCycles to the entry, unless its slot went to another object meanwhile
+void lockStatsSemWaited(LockStatsEntry * entry, const void * sem, uint64_t startCycles);
+void lockStatsSemPosted(const void * sem);
+#else
+#define lockStatsStart() 0
+#define lockStatsName(object, kind, name) ((void)0)
+#define lockStatsForget(object) ((void)0)
+#define lockStatsSemWaiting(sem, name, blocked) ((LockStatsEntry *)0)
+#define lockStatsSemWaited(entry, sem, startCycles) ((void)(entry), (void)(startCycles))
+#define lockStatsSemPosted(sem) ((void)0)
+#endif
+
+#endif
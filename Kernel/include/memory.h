@@ -2,6 +2,34 @@
 #define TP_SO_MEMORYMANAGER_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+// Owner recorded for blocks reserved by the kernel itself
+#define MEMORY_KERNEL_OWNER -1
+
+// Histograms group sizes in power-of-two classes: class i covers blocks of MEMORY_STATS_MIN_CLASS_SIZE << i bytes
+#define MEMORY_STATS_CLASSES 16
+#define MEMORY_STATS_MIN_CLASS_SIZE 32
+
+// Largest alignment myAlignedAlloc accepts, every allocator keeps its heap aligned to it
+#define MEMORY_MAX_ALIGNMENT 4096
+
+typedef struct MemoryStats {
+    int total;
+    int used;
+    int available;
+    int largestFreeBlock;                          // Biggest request that can currently succeed
+    int internalFragmentation;                     // Bytes reserved beyond what was requested
+    uint32_t allocationCount;
+    uint32_t freeCount;
+    uint32_t failedCount;
+    uint64_t maxMallocCycles;                      // Worst-case latency of a single call, in TSC cycles
+    uint64_t maxFreeCycles;
+    uint64_t mallocCycles;                         // Accumulated latency, divide by the counters for the average
+    uint64_t freeCycles;
+    uint32_t freeBlocks[MEMORY_STATS_CLASSES];     // Free blocks per order (buddy), free runs per length (bitmap) or free blocks per size (tlsf)
+    uint32_t requestSizes[MEMORY_STATS_CLASSES];   // Requests received per size class
+} MemoryStats;
 
 // Initializes the memory manager
 void initMemory(void);
@@ -9,12 +37,42 @@ void initMemory(void);
 // Reserves memory
 void * myMalloc(int size);
 
+// Reserves memory on behalf of the given process
+void * myMallocOwned(int size, int ownerPid);
+
+// Reserves zeroed memory for count elements of size bytes
+void * myCalloc(int count, int size);
+
+// Reserves zeroed memory on behalf of the given process
+void * myCallocOwned(int count, int size, int ownerPid);
+
+// Reserves memory at an address multiple of alignment (a power of two up to MEMORY_MAX_ALIGNMENT)
+void * myAlignedAlloc(int alignment, int size);
+
+// Reserves aligned memory on behalf of the given process
+void * myAlignedAllocOwned(int alignment, int size, int ownerPid);
+
+// Resizes a reservation keeping its owner and contents, growing it in place when the memory next to it is free
+void * myRealloc(void *ptr, int size);
+
 // Frees memory
 void myFree(void *ptr);
 
+// Frees every block reserved on behalf of the given process, returns the bytes released
+int myFreeOwnedBy(int ownerPid);
+
 // Gets memory statistics
 void memstats(int *total, int *used, int *available);
 
+// Gets allocator statistics, including fragmentation and the request profile
+void memstatsExtended(MemoryStats *stats);
+
+// Gets the bytes currently reserved on behalf of the given process
+int memstatsOwner(int ownerPid);
+
+// Gets the bytes reserved for the block at ptr and stores its owner, 0 when ptr is not a reserved block
+int memstatsBlock(void *ptr, int *ownerPid);
+
 // Validates if a pointer is within the heap and aligned
 int isValidHeapPtr(void *ptr);
 
@@ -0,0 +1,27 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include "memory.h"
+
+// Helpers shared by every allocator to keep the allocation profile reported by memstatsExtended
+
+// Class of a request: the smallest class whose blocks can hold size bytes
+int memoryStatsRequestClass(int size);
+// Class of a free region: the biggest class whose blocks fit in size bytes
+int memoryStatsBlockClass(int size);
+
+// Resets the counters and histograms
+void memoryStatsReset(void);
+// Passed as start timestamp when the operation should not be timed
+#define MEMORY_STATS_UNTIMED 0
+
+// Timestamp to pass to the record functions once the operation completes
+uint64_t memoryStatsStart(void);
+// Records a request, ptr is NULL when it failed
+void memoryStatsRecordAllocation(void *ptr, int requested, uint64_t startCycles);
+// Records the release of the block at ptr
+void memoryStatsRecordFree(void *ptr, uint64_t startCycles);
+// Copies the counters and the request histogram into stats
+void memoryStatsFill(MemoryStats *stats);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#include <stdint.h>
+
+typedef struct mutexCDT * mutexADT;
+typedef struct condCDT * condADT;
+struct Process;
+
+// Creates an unlocked mutex charged to creatorPid. A recursive mutex can be locked again by its owner and
+// is released once every lock has its unlock.
+mutexADT mutexCreate(uint8_t recursive, int creatorPid);
+// Returns 0 owning the mutex, -1 for a bad handle or when the owner relocks a non-recursive mutex
+int mutexLock(mutexADT mutex);
+// Like mutexLock but returns 1 instead of blocking when another process owns the mutex
+int mutexTryLock(mutexADT mutex);
+// Only the owner can unlock, anyone else gets -1. The mutex is handed to the oldest waiter, if any.
+int mutexUnlock(mutexADT mutex);
+// Fails with -1 while the mutex is locked or waited on
+int mutexDestroy(mutexADT mutex);
+// Hands every mutex a process that is going away still owns to its next waiter
+void mutexReleaseAll(struct Process * process);
+
+condADT condCreate(int creatorPid);
+// Releases the mutex, which the caller must own exactly once, and sleeps until signalled. Returns owning
+// the mutex again. Every process waiting on a condition at the same time must use the same mutex.
+int condWait(condADT cond, mutexADT mutex);
+// Moves the oldest waiter over to the mutex, it only runs once it owns the mutex
+int condSignal(condADT cond);
+// Moves every waiter over to the mutex instead of waking them all to fight for it
+int condBroadcast(condADT cond);
+// Fails with -1 while processes wait on the condition
+int condDestroy(condADT cond);
+
+#endif
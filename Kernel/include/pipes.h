@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+struct Process;
+
 #define MAX_PIPES 64
 #define PIPE_BUFFER_SIZE (1024 * 8) // 8K buffer size
 
@@ -28,6 +30,13 @@ typedef enum {
     PIPE_ROLE_WRITER,
 } PipeEndpointRole;
 
+// Where a vmsplice caller is, so pipeCancelLend knows what to undo if it dies
+typedef enum {
+    PIPE_LEND_DONE = 0,
+    PIPE_LEND_QUEUED,       // Counted in lendersWaiting, waiting for the ring to drain
+    PIPE_LEND_LENT,         // Its buffer is the pipe's lent buffer
+} PipeLendPhase;
+
 typedef struct {
     PipeEndpointType type;
     int pipeID; // valid only when type == PIPE_ENDPOINT_PIPE
@@ -36,8 +45,8 @@ typedef struct {
 
 // Initializes pipe structures and resets state.
 void initPipes(void);
-// Creates a new pipe and returns its identifier.
-int openPipe(void);
+// Creates a new pipe charged to ownerPid and returns its identifier.
+int openPipe(int ownerPid);
 // Closes the specified pipe and frees resources.
 int closePipe(int pipeID);
 // Reads up to size bytes from the given pipe into buffer.
@@ -45,6 +54,23 @@ int readPipe(int pipeID, uint8_t * buffer, int size);
 // Writes up to size bytes from buffer into the given pipe.
 int writePipe(int pipeID, uint8_t * buffer, int size);
 
+// Lends buffer to the pipe instead of copying it into the ring. Readers take the bytes straight from it, and
+// it returns once they consumed all of them, or with how many they did if the pipe closes first.
+int vmsplicePipe(int pipeID, const uint8_t * buffer, int size);
+
+// Takes back the buffer a process going away lends or waits to lend, copying what readers did not take yet
+void pipeCancelLend(struct Process * process);
+
+// Receives bytes already taken out of the pipe, returns how many it took or -1 on error. It runs without
+// the pipe lock, so it may block or turn interrupts on, but bytes it does not take are lost.
+typedef int (*PipeSink)(void * context, const uint8_t * data, int size);
+// Takes up to size bytes (512 at most) out of the pipe and hands them to sink, with no copy through the
+// caller's buffer. Blocks while the pipe is empty and open, returns what the sink took or 0 at end of file.
+int splicePipe(int pipeID, PipeSink sink, void * context, int size);
+// Moves up to size bytes from one pipe straight into the other's ring, with no buffer in between. Blocks
+// while in is empty or out is full, returns the bytes moved, 0 at end of file or -1 once out is closed.
+int splicePipes(int inID, int outID, int size);
+
 // Increments reader or writer references on a pipe.
 int pipeRetain(int pipeID, PipeEndpointRole role);
 // Decrements reader or writer references and closes when unused.
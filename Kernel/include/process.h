@@ -4,13 +4,20 @@
 #include "queue.h"
 #include "semaphores.h"
 #include "pipes.h"
+#include "resources.h"
 
-#define PROCESS_STACK_SIZE 4096
-#define MAX_PROCESSES 64
+#define PROCESS_STACK_SIZE 4096      // Used when creating a process without a stack size hint
+#define PROCESS_STACK_MIN_SIZE 4096  // Killing a process from its own stack (or the timer tick) needs ~1.7KB
+#define PROCESS_STACK_MAX_SIZE 16384
+#define PROCESS_STACK_PAINT 0xA5      // Stacks are filled with this byte to find how deep they were used
+#define MAX_PID 32767          // Heap blocks record their owner PID in 16 bits
 #define IDLE_PROCESS_PID 0
 #define INIT_PROCESS_PID 1
 #define SHELL_PROCESS_PID 2
 #define PROCESS_NAME_MAX_LENGTH 64
+#define PROCESS_EXIT_KILLED -1      // Exit status of a process that was killed instead of returning
+#define PROCESS_MAX_ZOMBIES 32      // Exit records kept per parent, the oldest is dropped when full
+#define WAIT_ANY_CHILD -2           // waiting_for_child value while blocked in waitAny
 
 typedef enum {
     MIN_PRIORITY = 0,
@@ -25,6 +32,13 @@ typedef enum ProcessState {
     PROCESS_STATE_TERMINATED
 } ProcessState;
 
+// Exit status of a child that finished and was not waited for yet
+typedef struct ZombieRecord {
+    int pid;
+    int status;
+    struct ZombieRecord * next;
+} ZombieRecord;
+
 typedef struct Process {
     int pid;
     int ppid;
@@ -34,14 +48,41 @@ typedef struct Process {
     int argc;
     char ** argv;
     uint8_t * stack_base;
+    int stack_size;
+    int stack_untouched;    // Painted bytes at the base as of the last stackHighWater, -1 before the first scan
     uint8_t * rip;   //function
     uint8_t * rsp;
-    int waiting_for_child; // PID of child this process is waiting for (-1 if not waiting)
+    int waiting_for_child; // PID of child this process is waiting for, WAIT_ANY_CHILD or -1 if not waiting
     uint8_t is_background; // 1 if the process was launched in background mode
     uint8_t is_foreground; // 1 if the process currently owns the foreground
     QueueADT children; // Queue of child PIDs
-    semADT wait_sem; // Semaphore for waiting on child processes
+    int exit_status;
+    ZombieRecord * zombies;          // Finished children in the order they ended
+    ZombieRecord * zombies_tail;
+    int zombie_count;
+    struct Process * child_waiters;  // Processes and threads blocked waiting for a child of this process
+    struct Process * child_wait_next;
     PipeEndpoint fds[PIPE_FD_COUNT];
+    struct Process * ready_next; // Links of the scheduler ready queue the process is in
+    struct Process * ready_prev;
+    int8_t ready_queue;          // Priority of the ready queue the process is linked in, -1 if none
+    struct Process * terminated_next; // Link of the queue of processes waiting to be removed
+    uint8_t in_terminated_queue;
+    uint8_t is_thread;               // Threads share the fds, children, name and heap accounting of their process
+    struct Process * thread_leader;  // Process the thread belongs to, NULL once that process is gone
+    struct Process * threads;        // Threads of the process, linked through thread_next
+    struct Process * thread_next;
+    int joiner_pid;                  // Thread blocked in joinThread on this one, -1 if none
+    uint64_t changed_generation;     // Table generation of the last change a snapshot reports
+    ResourceUsage resources;         // Charged to the process, threads charge their process instead
+    int32_t * futex_addr;            // Futex word the process sleeps on, NULL if none
+    struct WaitQueue * wait_queue;   // Semaphore, futex bucket, mutex, condition, rwlock or barrier queue
+                                     // the process is blocked in, NULL if none
+    struct Process * wait_next;      // Links of that wait queue
+    struct Process * wait_prev;
+    struct mutexCDT * mutexes_held;  // Mutexes the process owns, linked through the mutexes
+    int pipe_lending;                // Pipe the process lends a buffer to with vmsplice, or waits to, -1 if none
+    PipeLendPhase pipe_lend_phase;   // How far that lend got
 } Process;
 
 typedef struct ProcessInformation{
@@ -52,10 +93,63 @@ typedef struct ProcessInformation{
     uint8_t * rsp;
     uint8_t * stack_base;
     uint8_t is_foreground;
+    int stack_size;
+    int stack_used;     // High-water mark of the stack in bytes
+    ResourceUsage resources;
 } ProcessInformation;
 
+#define PROCESS_SNAPSHOT_REMOVED_MAX 32
+
+// Header of a process table snapshot. Passing generation back as since returns only what changed after it.
+typedef struct ProcessSnapshot {
+    uint64_t generation;
+    int count;          // Entries written to the table
+    int total;          // Processes that exist
+    uint8_t full;       // 1 when the table holds every process instead of only the changed ones
+    int removedCount;
+    int removed[PROCESS_SNAPSHOT_REMOVED_MAX];  // PIDs removed since the given generation
+} ProcessSnapshot;
+
+#define SPAWN_MAX_FILE_ACTIONS PIPE_FD_COUNT
+#define SPAWN_INHERIT_PRIORITY -1
+
+// Points fd of the new process at the given target instead of the parent's
+typedef struct SpawnFileAction {
+    int fd;
+    PipeEndpointType type;
+    int pipeID;     // valid only when type == PIPE_ENDPOINT_PIPE
+} SpawnFileAction;
+
+typedef struct SpawnAttributes {
+    SpawnFileAction actions[SPAWN_MAX_FILE_ACTIONS];
+    int actionCount;
+    int priority;   // SPAWN_INHERIT_PRIORITY keeps the parent's
+    uint8_t is_background;
+    int stackSize;  // 0 uses PROCESS_STACK_SIZE
+} SpawnAttributes;
+
+#define SPAWN_BATCH_MAX 64     // Bounds how long a batch keeps interrupts off
+
+typedef struct SpawnRequest {
+    void * function;
+    int argc;
+    char ** argv;
+    SpawnAttributes attributes;
+} SpawnRequest;
+
 int getNextPid(void);
-Process * createProcess(void * function, int argc, char ** argv, ProcessPriority priority, int parentID, uint8_t is_background);
+// stackSize is rounded up to a power of two between PROCESS_STACK_MIN_SIZE and PROCESS_STACK_MAX_SIZE, 0 uses PROCESS_STACK_SIZE
+Process * createProcess(void * function, int argc, char ** argv, ProcessPriority priority, int parentID, uint8_t is_background, int stackSize);
+// Creates a process with its fds already pointing where the attributes say, the parent's fds are left untouched
+Process * spawnProcess(void * function, int argc, char ** argv, int parentID, const SpawnAttributes * attributes);
+// Spawns every request in order, stopping at the first failure. Returns how many were created, pids of the rest are -1.
+int spawnBatch(const SpawnRequest * requests, int count, int parentID, int32_t * pids);
+// Creates a thread of the current process running function(arg)
+Process * createThread(void * function, void * arg, int stackSize);
+// Waits for a thread of the same process to finish and releases it
+int joinThread(int tid);
+// Process whose fds, children and heap accounting the given process or thread uses
+Process * processGroupLeader(Process * process);
 void removeProcess(Process * p);
 void freeProcess(Process * p);
 void processCleanupTerminated(Process *exclude);
@@ -65,16 +159,27 @@ int kill(int pid);
 int block(int pid);
 int unblock(int pid);
 int nice(int pid, int newPriority);
-int waitPid(int pid);
+// Waits for the given child and stores its exit status when status is not NULL
+int waitPid(int pid, int * status);
+// Waits for whichever child finishes first, returns its PID or -1 when there are no children
+// Both miss a child whose exit record was dropped, see PROCESS_MAX_ZOMBIES
+int waitAny(int * status);
 int waitChildren(void);
+// Ends the current process with the given status, used when its entry function returns
+void exitCurrentProcess(int status);
 Process * getProcess(int pid);
 int getProcessInfo(int pid, ProcessInformation * info);
+int stackHighWater(Process * process);
 Process * getForegroundProcess(void);
 void setForegroundProcess(Process * process);
 void releaseForegroundProcess(Process * process);
 int killForegroundProcess(void);
 int startInitProcess(void * shellEntryPoint);
-int ps(ProcessInformation * processInfoTable); // Always recieves a table of MAX_PROCESSES size
+int ps(ProcessInformation * processInfoTable, int maxCount); // Returns how many processes exist when the table is NULL
+// Copies the whole table in one pass, or only what changed after since when that is still known. Returns count.
+int processSnapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot);
+// Marks a change to the state, priority or foreground flag of a process for delta snapshots
+void processChanged(Process * process);
 int changePriority(int pid, ProcessPriority newPriority);
 int getCurrentPid();
 
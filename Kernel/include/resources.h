@@ -0,0 +1,43 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+typedef enum {
+    RESOURCE_HEAP = 0,      // Bytes of heap reserved through malloc, calloc, aligned alloc and realloc
+    RESOURCE_STACK,         // Bytes of stack of the process and its threads
+    RESOURCE_PIPES,         // Pipes the process opened that are still alive
+    RESOURCE_SEMAPHORES,    // Semaphores the process created that are still alive
+    RESOURCE_COUNT
+} ResourceType;
+
+#define RESOURCE_UNLIMITED -1
+
+// Free heap only the idle, init and shell processes may dip into, so the shell can still spawn commands
+#ifndef SHELL_HEAP_RESERVE
+#define SHELL_HEAP_RESERVE (32 * 1024)
+#endif
+
+typedef struct ResourceUsage {
+    int usage[RESOURCE_COUNT];
+    int limits[RESOURCE_COUNT];     // RESOURCE_UNLIMITED or the most usage may grow to
+} ResourceUsage;
+
+// Starts a process with nothing charged and the limits of its parent, unlimited when parent is NULL
+void resourceInit(ResourceUsage * resources, const ResourceUsage * parent);
+
+// Checks that the process may take amount more of the resource. Charges go to the process a thread belongs to,
+// PIDs without a process (the kernel) are never limited.
+int resourceCheck(int pid, ResourceType type, int amount);
+
+// Adds delta to the usage without checking the limit, usage never goes below zero
+void resourceAdd(int pid, ResourceType type, int delta);
+
+// resourceCheck followed by resourceAdd, returns -1 and charges nothing when over the limit
+int resourceCharge(int pid, ResourceType type, int amount);
+
+// Checks that a process created by parentPid may get a stack of stackSize bytes
+int resourceCheckChild(int parentPid, int stackSize);
+
+int setResourceLimit(int pid, ResourceType type, int limit);
+int getResourceUsage(int pid, ResourceUsage * resources);
+
+#endif
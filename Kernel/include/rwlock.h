@@ -0,0 +1,19 @@
+#ifndef RWLOCK_H
+#define RWLOCK_H
+
+#include <stdint.h>
+
+typedef struct rwlockCDT * rwlockADT;
+
+// Reader-writer lock with writer preference: once a writer waits, new readers queue behind it. When a
+// writer leaves, every reader queued by then is let in together before the next writer.
+rwlockADT rwlockCreate(int creatorPid);
+int rwlockReadLock(rwlockADT lock);
+// Returns -1 when the caller already holds the write side
+int rwlockWriteLock(rwlockADT lock);
+// Releases the side the caller holds, the write side if it is the writer
+int rwlockUnlock(rwlockADT lock);
+// Fails with -1 while the lock is held or waited on
+int rwlockDestroy(rwlockADT lock);
+
+#endif
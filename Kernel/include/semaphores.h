@@ -6,16 +6,33 @@
 
 typedef struct semCDT * semADT;
 
+// Opens the named semaphore, creating it with initial_count the first time. Every open needs its semDestroy.
 semADT semInit(const char *name, uint32_t initial_count);
+// Like semInit, charging the semaphore to ownerPid when it has to be created
+semADT semInitOwned(const char *name, uint32_t initial_count, int ownerPid);
+// Creates a semaphore only reachable through the returned handle, it never enters the name registry
+semADT semCreate(uint32_t initial_count);
 int post(semADT sem);
 int wait(semADT sem);
 void semDestroy(semADT sem);
 int semGetBlockedCount(semADT sem);
+// Unblocks every waiter in one pass without rescheduling, returns how many there were
+int semWakeAll(semADT sem);
+// semWakeAll followed by a single yield when anyone was woken
 void wakeBlocked(semADT sem);
 
 void semLock(uint8_t *lock);
 void semUnlock(uint8_t *lock);
+// Single attempt, returns 0 when the lock was taken
+int semTryLock(uint8_t *lock);
 
-int initSemaphoreQueue(void);
+#ifdef LOCK_STATS
+#include "lockStats.h"
+// Every spinlock goes through the profiler, which spins with semTryLock
+#define semLock(lock) lockStatsSpinLock(lock)
+#define semUnlock(lock) lockStatsSpinUnlock(lock)
+#endif
+
+int initSemaphoreRegistry(void);
 
 #endif
\ No newline at end of file
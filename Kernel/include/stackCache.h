@@ -0,0 +1,51 @@
+#ifndef STACK_CACHE_H
+#define STACK_CACHE_H
+
+#include <stdint.h>
+
+// Stacks are cached per power-of-two size, from STACK_CACHE_MIN_SIZE up to STACK_CACHE_MIN_SIZE << (STACK_CACHE_CLASSES - 1)
+#define STACK_CACHE_CLASSES 3
+#define STACK_CACHE_MIN_SIZE 4096
+
+// Stacks kept per size before they are given back to the heap
+#ifndef STACK_CACHE_HIGH_WATER
+#define STACK_CACHE_HIGH_WATER 4
+#endif
+
+// Stacks of PROCESS_STACK_SIZE reserved at boot
+#ifndef STACK_CACHE_PREFILL
+#define STACK_CACHE_PREFILL 0
+#endif
+
+typedef struct StackCacheStats {
+    uint32_t hits;        // Stacks handed out from the cache
+    uint32_t misses;      // Stacks that had to be reserved from the heap
+    uint32_t released;    // Stacks given back to the heap because their size was at the high-water mark
+    uint32_t cached;      // Stacks currently waiting in the cache
+    uint32_t highWater;
+    uint32_t peakUsage;   // Deepest stack use seen in a process that exited, in bytes
+    uint32_t exhausted;   // Exited processes that used their whole stack and probably overflowed it
+} StackCacheStats;
+
+// Resets the cache and pre-populates it with STACK_CACHE_PREFILL stacks
+void stackCacheInit(void);
+
+// Returns a stack of the given size, reusing the most recently released one when possible
+void * stackCacheAlloc(int size);
+
+// Keeps the stack for the next process unless its size is already at the high-water mark
+void stackCacheFree(void * stack, int size);
+
+// Gives every cached stack back to the heap, returns the bytes released. Allocations that fail call it
+// and retry once.
+int stackCacheFlush(void);
+
+// Bytes held by cached stacks, which a failed allocation would get back
+int stackCacheBytes(void);
+
+// Records how deep the stack of an exiting process was used
+void stackCacheRecordUsage(int used, int size);
+
+void stackCacheGetStats(StackCacheStats * stats);
+
+#endif
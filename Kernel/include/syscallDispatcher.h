@@ -7,6 +7,13 @@
 #include <process.h>
 #include <semaphores.h>
 #include <pipes.h>
+#include <memory.h>
+#include <stackCache.h>
+#include <futex.h>
+#include <mutex.h>
+#include <rwlock.h>
+#include <barrier.h>
+#include <lockStats.h>
 
 
 typedef struct {
@@ -36,6 +43,8 @@ int32_t sys_read(int32_t fd, signed char * __user_buf, int32_t count);
 int32_t sys_pipe(int pipefd[2]);
 int32_t sys_close_pipe(int pipeID);
 int32_t sys_set_fd_target(int fd, PipeEndpointType type, int pipeID);
+int32_t sys_vmsplice(int32_t fd, const char * buf, int32_t count);
+int32_t sys_splice(int32_t fdIn, int32_t fdOut, int32_t count);
 
 // Custom syscall prototypes
 int32_t sys_start_beep(uint32_t nFrequence);
@@ -79,20 +88,34 @@ int32_t sys_get_character_without_display(void);
 
 // =============== Memory management syscalls ================
 void * sys_malloc(int size);
+void * sys_realloc(void * ptr, int size);
+void * sys_calloc(int count, int size);
+void * sys_aligned_alloc(int alignment, int size);
 int32_t sys_free(void * ptr);
 int32_t sys_memstats(int * total, int * used, int * available);
+int32_t sys_memstats_pid(int pid);
+int32_t sys_memstats_extended(MemoryStats * stats);
+int32_t sys_stack_cache_stats(StackCacheStats * stats);
 
 // =============== Process management syscalls ================
 int32_t sys_getpid(void);
-int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_background);
+int32_t sys_create_process(void * function, int argc, char ** argv, uint8_t is_background, int stackSize);
 int32_t sys_unblock(int pid);
 int32_t sys_block(int pid);
 int32_t sys_kill(int pid);
 int32_t sys_nice(int pid, int newPriority);
-int32_t sys_wait_pid(int pid);
+int32_t sys_wait_pid(int pid, int * status);
+int32_t sys_wait_any(int * status);
 int32_t sys_wait_children(void);
-int32_t sys_ps(ProcessInformation * processInfoTable);
+int32_t sys_ps(ProcessInformation * processInfoTable, int maxCount);
+int32_t sys_process_snapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot);
+int32_t sys_set_resource_limit(int pid, ResourceType type, int limit);
+int32_t sys_get_resource_usage(int pid, ResourceUsage * resources);
 int32_t sys_get_process_info(int pid, ProcessInformation *info);
+int32_t sys_thread_create(void * function, void * arg, int stackSize);
+int32_t sys_thread_join(int tid);
+int32_t sys_spawn(void * function, int argc, char ** argv, const SpawnAttributes * attributes);
+int32_t sys_spawn_batch(const SpawnRequest * requests, int count, int32_t * pids);
 int32_t sys_yield(void);
 
 // =============== Semaphore management syscalls ================
@@ -100,5 +123,30 @@ semADT sys_sem_init(const char *name, uint32_t initial_count);
 int32_t sys_sem_post(semADT sem);
 int32_t sys_sem_wait(semADT sem);
 int32_t sys_sem_destroy(semADT sem);
+int32_t sys_futex_wait(int32_t * addr, int32_t expected);
+int32_t sys_futex_wake(int32_t * addr, int count);
+mutexADT sys_mutex_create(uint8_t recursive);
+int32_t sys_mutex_lock(mutexADT mutex);
+int32_t sys_mutex_trylock(mutexADT mutex);
+int32_t sys_mutex_unlock(mutexADT mutex);
+int32_t sys_mutex_destroy(mutexADT mutex);
+condADT sys_cond_create(void);
+int32_t sys_cond_wait(condADT cond, mutexADT mutex);
+int32_t sys_cond_signal(condADT cond);
+int32_t sys_cond_broadcast(condADT cond);
+int32_t sys_cond_destroy(condADT cond);
+rwlockADT sys_rwlock_create(void);
+int32_t sys_rwlock_read_lock(rwlockADT lock);
+int32_t sys_rwlock_write_lock(rwlockADT lock);
+int32_t sys_rwlock_unlock(rwlockADT lock);
+int32_t sys_rwlock_destroy(rwlockADT lock);
+barrierADT sys_barrier_create(int parties);
+int32_t sys_barrier_wait(barrierADT barrier);
+int32_t sys_barrier_destroy(barrierADT barrier);
+latchADT sys_latch_create(int count);
+int32_t sys_latch_count_down(latchADT latch, int count);
+int32_t sys_latch_wait(latchADT latch);
+int32_t sys_latch_destroy(latchADT latch);
+int32_t sys_lock_stats(LockStatsEntry * table, int maxCount);
 
 #endif
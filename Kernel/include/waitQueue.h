@@ -0,0 +1,24 @@
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+struct Process;
+
+// FIFO of blocked processes linked through their PCBs, so waiting never allocates. A process sits in at
+// most one wait queue at a time. Callers run with interrupts off, as every syscall does.
+typedef struct WaitQueue {
+    struct Process * head;
+    struct Process * tail;
+    int count;
+} WaitQueue;
+
+void waitQueueInit(WaitQueue * queue);
+void waitQueueAppend(WaitQueue * queue, struct Process * process);
+// Takes the oldest waiter out of the queue, NULL when nobody is waiting
+struct Process * waitQueuePop(WaitQueue * queue);
+void waitQueueUnlink(WaitQueue * queue, struct Process * process);
+// Empties the queue and unblocks every waiter in one pass without rescheduling, returns how many there were
+int waitQueueWakeAll(WaitQueue * queue);
+// Takes a process that is going away out of the wait queue it is blocked in, if any
+void waitQueueCancel(struct Process * process);
+
+#endif
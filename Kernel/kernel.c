@@ -14,6 +14,7 @@
 #include <panic.h>
 #include "time.h"
 #include "process.h"
+#include "stackCache.h"
 #include "semaphores.h"
 #include "pipes.h"
 #include <keyboard.h>
@@ -62,9 +63,10 @@ void * initializeKernelBinary(){
 int main(){	
 	load_idt();
 	initMemory();
+	stackCacheInit();
 	initPCBTable();
 	initScheduler();
-	initSemaphoreQueue();
+	initSemaphoreRegistry();
 	initPipes();
 	setFontSize(2);
 	initKeySem();
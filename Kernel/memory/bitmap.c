@@ -1,6 +1,7 @@
 
 
 #include "memory.h"
+#include "memoryStats.h"
 #include <stdint.h>
 #include <string.h>
 
@@ -13,14 +14,18 @@
 
 // Bitmap and heap structure
 typedef struct {
+    uint8_t heap[HEAP_SIZE];                      // Actual heap where memory is stored (first so it keeps the struct alignment)
     uint8_t bitmap[BITMAP_NUM_BYTES];          // Each bit represents a block (1=used, 0=free)
-    uint8_t heap[HEAP_SIZE];                      // Actual heap where memory is stored
+    uint8_t zero_map[BITMAP_NUM_BYTES];        // Each bit marks a block known to hold only zeros
     uint16_t allocation_map[NUM_BLOCKS];          // Blocks occupied by reservation (only for the initial block)
+    int16_t owner_map[NUM_BLOCKS];                // PID the reservation belongs to (only for the initial block)
+    uint8_t slack_map[NUM_BLOCKS];                // Reserved bytes past the requested size (only for the initial block)
     int blocks_used;                           // Number of blocks in use
+    int internal_fragmentation;                // Sum of the slack of every live reservation
 } MemoryManager;
 
 // Global memory manager instance
-static MemoryManager mm;
+static MemoryManager mm __attribute__((aligned(MEMORY_MAX_ALIGNMENT)));
 
 // ==================== Helper Functions ====================
 
@@ -45,6 +50,14 @@ static void mark_block_free(int block_index) {
     mm.bitmap[byte_index] &= ~(1 << bit_index);
 }
 
+static int is_block_zeroed(int block_index) {
+    return (mm.zero_map[block_index / BITS_PER_BYTE] >> (block_index % BITS_PER_BYTE)) & 1;
+}
+
+static void mark_block_dirty(int block_index) {
+    mm.zero_map[block_index / BITS_PER_BYTE] &= ~(1 << (block_index % BITS_PER_BYTE));
+}
+
 // Finds contiguous free blocks
 static int find_free_blocks(int num_blocks_needed) {
     int consecutive_free = 0;
@@ -68,79 +81,275 @@ static int find_free_blocks(int num_blocks_needed) {
     return NUM_BLOCKS;
 }
 
+// Finds contiguous free blocks whose first index is a multiple of block_alignment
+static int find_free_blocks_aligned(int num_blocks_needed, int block_alignment) {
+    int start_block = 0;
+
+    while (start_block + num_blocks_needed <= NUM_BLOCKS) {
+        int free_run = 0;
+        while (free_run < num_blocks_needed && !is_block_used(start_block + free_run)) {
+            free_run++;
+        }
+        if (free_run == num_blocks_needed) {
+            return start_block;
+        }
+
+        // Restarts at the first aligned block past the used one
+        int next_block = start_block + free_run + 1;
+        start_block = ((next_block + block_alignment - 1) / block_alignment) * block_alignment;
+    }
+
+    return NUM_BLOCKS;
+}
+
+// Reserves the blocks for a request, returns the first one or NUM_BLOCKS when there is no room
+static int reserve_blocks(int size, int block_alignment, int ownerPid, uint64_t start) {
+    // The size is bounded before rounding up, near INT_MAX it would overflow into a negative block count
+    int blocks_needed = (size > 0 && size <= HEAP_SIZE) ? (size + BLOCK_SIZE - 1) / BLOCK_SIZE : 0;
+    if (blocks_needed == 0 || blocks_needed > NUM_BLOCKS || blocks_needed >= BLOCK_CONTINUATION) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NUM_BLOCKS;
+    }
+
+    int start_block = (block_alignment > 1) ? find_free_blocks_aligned(blocks_needed, block_alignment)
+                                            : find_free_blocks(blocks_needed);
+    if (start_block == NUM_BLOCKS) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NUM_BLOCKS;  // Not enough memory available
+    }
+
+    for (int i = 0; i < blocks_needed; i++) {
+        mark_block_used(start_block + i);
+    }
+
+    mm.blocks_used += blocks_needed;
+    mm.allocation_map[start_block] = (uint16_t)blocks_needed;
+    mm.owner_map[start_block] = (int16_t)ownerPid;
+    mm.slack_map[start_block] = (uint8_t)(blocks_needed * BLOCK_SIZE - size);
+    mm.internal_fragmentation += mm.slack_map[start_block];
+    memoryStatsRecordAllocation(&mm.heap[start_block * BLOCK_SIZE], size, start);
+    for (int i = 1; i < blocks_needed; i++) {
+        mm.allocation_map[start_block + i] = BLOCK_CONTINUATION;
+    }
+    return start_block;
+}
+
+// Returns the first block of the reservation that starts at ptr, or NUM_BLOCKS if there is none
+static int lookup_reservation(void *ptr) {
+    uint8_t *ptr_byte = (uint8_t *)ptr;
+    if (ptr_byte < mm.heap || ptr_byte >= mm.heap + HEAP_SIZE) {
+        return NUM_BLOCKS;
+    }
+
+    int offset = ptr_byte - mm.heap;
+    if (offset % BLOCK_SIZE != 0) {
+        return NUM_BLOCKS;
+    }
+
+    int start_block = offset / BLOCK_SIZE;
+    uint16_t blocks_tracked = mm.allocation_map[start_block];
+    if (blocks_tracked == 0 || blocks_tracked == BLOCK_CONTINUATION) {
+        return NUM_BLOCKS;
+    }
+    return start_block;
+}
+
+// Releases the reservation that starts at the given block, returns the number of blocks freed
+static int release_blocks(int start_block, uint64_t start_cycles) {
+    uint16_t blocks_to_free = mm.allocation_map[start_block];
+
+    // Frees contiguous blocks until a free one is found
+    for (int i = 0; i < blocks_to_free && (start_block + i) < NUM_BLOCKS; i++) {
+        mark_block_free(start_block + i);
+        mm.allocation_map[start_block + i] = 0;
+    }
+    mm.owner_map[start_block] = MEMORY_KERNEL_OWNER;
+    mm.internal_fragmentation -= mm.slack_map[start_block];
+    mm.slack_map[start_block] = 0;
+    memoryStatsRecordFree(&mm.heap[start_block * BLOCK_SIZE], start_cycles);
+
+    if (mm.blocks_used >= (int)blocks_to_free) {
+        mm.blocks_used -= (int)blocks_to_free;
+    } else {
+        mm.blocks_used = 0;
+    }
+    return blocks_to_free;
+}
+
 // ==================== Public Functions ====================
 void initMemory(void) {
     memset(mm.bitmap, 0, sizeof(mm.bitmap));
     memset(mm.allocation_map, 0, sizeof(mm.allocation_map));
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        mm.owner_map[i] = MEMORY_KERNEL_OWNER;
+    }
+    memset(mm.slack_map, 0, sizeof(mm.slack_map));
     memset(mm.heap, 0, sizeof(mm.heap));
+    memset(mm.zero_map, 0xFF, sizeof(mm.zero_map));
     mm.blocks_used = 0;
+    mm.internal_fragmentation = 0;
+    memoryStatsReset();
 }
 
 void * myMalloc(int size) {
+    return myMallocOwned(size, MEMORY_KERNEL_OWNER);
+}
+
+void * myMallocOwned(int size, int ownerPid) {
     if (size == 0) {
         return NULL;
     }
-    
-    int blocks_needed = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    if (blocks_needed <= 0 || blocks_needed > NUM_BLOCKS || blocks_needed >= BLOCK_CONTINUATION) {
+
+    uint64_t start = memoryStatsStart();
+    int start_block = reserve_blocks(size, 1, ownerPid, start);
+    if (start_block == NUM_BLOCKS) {
         return NULL;
     }
-    
-    int start_block = find_free_blocks(blocks_needed);
-    
+
+    int blocks_reserved = mm.allocation_map[start_block];
+    for (int i = 0; i < blocks_reserved; i++) {
+        mark_block_dirty(start_block + i);
+    }
+
+    // Returns a pointer to the beginning of the block in the heap
+    return (void *)&mm.heap[start_block * BLOCK_SIZE];
+}
+
+void * myCalloc(int count, int size) {
+    return myCallocOwned(count, size, MEMORY_KERNEL_OWNER);
+}
+
+void * myCallocOwned(int count, int size, int ownerPid) {
+    uint64_t start = memoryStatsStart();
+    int total = (count > 0 && size > 0 && count <= HEAP_SIZE / size) ? count * size : -1;
+    int start_block = reserve_blocks(total, 1, ownerPid, start);
     if (start_block == NUM_BLOCKS) {
-        return NULL;  // Not enough memory available
+        return NULL;
     }
-    
-    for (int i = 0; i < blocks_needed; i++) {
-        mark_block_used(start_block + i);
+
+    // Only the blocks written since boot need to be cleared
+    int blocks_reserved = mm.allocation_map[start_block];
+    for (int i = 0; i < blocks_reserved; i++) {
+        if (!is_block_zeroed(start_block + i)) {
+            memset(&mm.heap[(start_block + i) * BLOCK_SIZE], 0, BLOCK_SIZE);
+        }
+        mark_block_dirty(start_block + i);
     }
-    
-    mm.blocks_used += blocks_needed;
-    mm.allocation_map[start_block] = (uint16_t)blocks_needed;
-    for (int i = 1; i < blocks_needed; i++) {
-        mm.allocation_map[start_block + i] = BLOCK_CONTINUATION;
+    return (void *)&mm.heap[start_block * BLOCK_SIZE];
+}
+
+void * myAlignedAlloc(int alignment, int size) {
+    return myAlignedAllocOwned(alignment, size, MEMORY_KERNEL_OWNER);
+}
+
+void * myAlignedAllocOwned(int alignment, int size, int ownerPid) {
+    if (alignment <= 0 || alignment > MEMORY_MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        return NULL;
     }
 
-    // Returns a pointer to the beginning of the block in the heap
+    // The heap starts page aligned, so aligning the block index aligns the address
+    uint64_t start = memoryStatsStart();
+    int block_alignment = (alignment > BLOCK_SIZE) ? alignment / BLOCK_SIZE : 1;
+    int start_block = reserve_blocks(size, block_alignment, ownerPid, start);
+    if (start_block == NUM_BLOCKS) {
+        return NULL;
+    }
+
+    int blocks_reserved = mm.allocation_map[start_block];
+    for (int i = 0; i < blocks_reserved; i++) {
+        mark_block_dirty(start_block + i);
+    }
     return (void *)&mm.heap[start_block * BLOCK_SIZE];
 }
 
-void myFree(void *ptr) {
+void * myRealloc(void *ptr, int size) {
     if (ptr == NULL) {
-        return;
+        return myMalloc(size);
+    }
+    if (size <= 0) {
+        myFree(ptr);
+        return NULL;
     }
-    
-    uint8_t *ptr_byte = (uint8_t *)ptr;
-    uint8_t *heap_start = mm.heap;
-    uint8_t *heap_end = mm.heap + HEAP_SIZE;
 
-    if (ptr_byte < heap_start || ptr_byte >= heap_end) {
-        return;
+    if (size > HEAP_SIZE) {
+        return NULL;
+    }
+    int start_block = lookup_reservation(ptr);
+    int blocks_needed = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (start_block == NUM_BLOCKS || blocks_needed > NUM_BLOCKS || blocks_needed >= BLOCK_CONTINUATION) {
+        return NULL;
     }
 
-    int offset = ptr_byte - heap_start;
-    if (offset % BLOCK_SIZE != 0) {
-        return;
+    int blocks_reserved = mm.allocation_map[start_block];
+    int old_requested = blocks_reserved * BLOCK_SIZE - mm.slack_map[start_block];
+
+    // Grows over the blocks right after the reservation when they are all free
+    int fits_in_place = start_block + blocks_needed <= NUM_BLOCKS;
+    for (int i = blocks_reserved; fits_in_place && i < blocks_needed; i++) {
+        fits_in_place = !is_block_used(start_block + i);
     }
 
-    int start_block = offset / BLOCK_SIZE;
-    uint16_t blocks_to_free = mm.allocation_map[start_block];
-    if (blocks_to_free == 0 || blocks_to_free == BLOCK_CONTINUATION) {
-        return;
+    if (!fits_in_place) {
+        void *moved = myMallocOwned(size, mm.owner_map[start_block]);
+        if (moved == NULL) {
+            return NULL;
+        }
+        memcpy(moved, ptr, (size_t)(old_requested < size ? old_requested : size));
+        myFree(ptr);
+        return moved;
     }
 
-    // Frees contiguous blocks until a free one is found
-    for (int i = 0; i < blocks_to_free && (start_block + i) < NUM_BLOCKS; i++) {
+    for (int i = blocks_reserved; i < blocks_needed; i++) {
+        mark_block_used(start_block + i);
+        mark_block_dirty(start_block + i);
+        mm.allocation_map[start_block + i] = BLOCK_CONTINUATION;
+    }
+    for (int i = blocks_needed; i < blocks_reserved; i++) {
         mark_block_free(start_block + i);
         mm.allocation_map[start_block + i] = 0;
     }
+
+    mm.blocks_used += blocks_needed - blocks_reserved;
+    mm.allocation_map[start_block] = (uint16_t)blocks_needed;
+    mm.internal_fragmentation -= mm.slack_map[start_block];
+    mm.slack_map[start_block] = (uint8_t)(blocks_needed * BLOCK_SIZE - size);
+    mm.internal_fragmentation += mm.slack_map[start_block];
+    return ptr;
+}
+
+void myFree(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
     
-    if (mm.blocks_used >= (int)blocks_to_free) {
-        mm.blocks_used -= (int)blocks_to_free;
-    } else {
-        mm.blocks_used = 0;
+    uint64_t start = memoryStatsStart();
+    int start_block = lookup_reservation(ptr);
+    if (start_block == NUM_BLOCKS) {
+        return;
+    }
+
+    release_blocks(start_block, start);
+}
+
+int myFreeOwnedBy(int ownerPid) {
+    if (ownerPid == MEMORY_KERNEL_OWNER) {
+        return 0;
     }
+
+    int released = 0;
+    int block = 0;
+    while (block < NUM_BLOCKS) {
+        uint16_t blocks_tracked = mm.allocation_map[block];
+        if (blocks_tracked == 0 || blocks_tracked == BLOCK_CONTINUATION) {
+            block++;
+            continue;
+        }
+        if (mm.owner_map[block] == ownerPid) {
+            released += release_blocks(block, MEMORY_STATS_UNTIMED) * BLOCK_SIZE;
+        }
+        block += blocks_tracked;
+    }
+    return released;
 }
 
 void memstats(int *total, int *used, int *available) {
@@ -157,6 +366,68 @@ void memstats(int *total, int *used, int *available) {
     }
 }
 
+void memstatsExtended(MemoryStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    memstats(&stats->total, &stats->used, &stats->available);
+    memoryStatsFill(stats);
+    stats->internalFragmentation = mm.internal_fragmentation;
+    stats->largestFreeBlock = 0;
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        stats->freeBlocks[i] = 0;
+    }
+
+    // Every maximal run of free blocks is one free region
+    int run_length = 0;
+    for (int i = 0; i <= NUM_BLOCKS; i++) {
+        if (i < NUM_BLOCKS && !is_block_used(i)) {
+            run_length++;
+            continue;
+        }
+        if (run_length > 0) {
+            int run_bytes = run_length * BLOCK_SIZE;
+            stats->freeBlocks[memoryStatsBlockClass(run_bytes)]++;
+            if (run_bytes > stats->largestFreeBlock) {
+                stats->largestFreeBlock = run_bytes;
+            }
+            run_length = 0;
+        }
+    }
+}
+
+int memstatsOwner(int ownerPid) {
+    int owned = 0;
+    int block = 0;
+    while (block < NUM_BLOCKS) {
+        uint16_t blocks_tracked = mm.allocation_map[block];
+        if (blocks_tracked == 0 || blocks_tracked == BLOCK_CONTINUATION) {
+            block++;
+            continue;
+        }
+        if (mm.owner_map[block] == ownerPid) {
+            owned += blocks_tracked * BLOCK_SIZE;
+        }
+        block += blocks_tracked;
+    }
+    return owned;
+}
+
+int memstatsBlock(void *ptr, int *ownerPid) {
+    if (ptr == NULL) {
+        return 0;
+    }
+    int start_block = lookup_reservation(ptr);
+    if (start_block == NUM_BLOCKS) {
+        return 0;
+    }
+    if (ownerPid != NULL) {
+        *ownerPid = mm.owner_map[start_block];
+    }
+    return mm.allocation_map[start_block] * BLOCK_SIZE;
+}
+
 int isValidHeapPtr(void *ptr) {
     if (ptr == NULL) {
         return 0;
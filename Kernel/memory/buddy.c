@@ -1,7 +1,10 @@
 
 
+#include "memory.h"
+#include "memoryStats.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #define MIN_BLOCK_ORDER 5
 #define MAX_BLOCK_ORDER 19
@@ -19,12 +22,16 @@ typedef struct TreeNode {
     uint32_t offset;
     uint8_t block_order;
     uint8_t status;
+    int16_t owner;      // PID the block was reserved for (only meaningful when occupied)
+    uint32_t requested; // Bytes asked for when the block was reserved (only meaningful when occupied)
 } TreeNode;
 
-static uint8_t heap[TOTAL_HEAP_SIZE];
+static uint8_t heap[TOTAL_HEAP_SIZE] __attribute__((aligned(MEMORY_MAX_ALIGNMENT)));
 static TreeNode tree_nodes[TOTAL_NODES];
+static uint64_t zeroed_nodes[(TOTAL_NODES + 63) / 64];   // Available blocks whose memory is known to be all zeros
 static int allocator_initialized = 0;
 static int total_free_bytes = TOTAL_HEAP_SIZE;
+static int internal_fragmentation = 0;
 
 
 // ========== Helper Functions ========== 
@@ -32,12 +39,26 @@ static int total_free_bytes = TOTAL_HEAP_SIZE;
 static int get_block_size(int order) {
     return (int)1u << order;
 }
+static int is_zeroed(int idx) {
+    return (zeroed_nodes[idx / 64] >> (idx % 64)) & 1;
+}
+
+static void set_zeroed(int idx, int zeroed) {
+    if (zeroed) {
+        zeroed_nodes[idx / 64] |= (1ull << (idx % 64));
+    } else {
+        zeroed_nodes[idx / 64] &= ~(1ull << (idx % 64));
+    }
+}
+
 // Recursively builds the buddy tree starting from the given node.
 static void build_tree(int idx, int order, uint32_t offset) {
     TreeNode *current = &tree_nodes[idx];
     current->offset = offset;
     current->block_order = (uint8_t)order;
     current->status = STATUS_AVAILABLE;
+    current->owner = MEMORY_KERNEL_OWNER;
+    current->requested = 0;
 
     if (order > MIN_BLOCK_ORDER) {
         int left_idx = (idx * 2) + 1;
@@ -90,6 +111,8 @@ static int find_and_allocate(int idx, int order) {
 
     if (current->status == STATUS_AVAILABLE) {
         current->status = STATUS_DIVIDED;
+        set_zeroed(left_idx, is_zeroed(idx));
+        set_zeroed(right_idx, is_zeroed(idx));
     }
 
     int allocated = find_and_allocate(left_idx, order);
@@ -122,6 +145,7 @@ static void merge_upwards(int idx) {
 
         if (tree_nodes[left_idx].status == STATUS_AVAILABLE && tree_nodes[right_idx].status == STATUS_AVAILABLE) {
             tree_nodes[parent_idx].status = STATUS_AVAILABLE;
+            set_zeroed(parent_idx, is_zeroed(left_idx) && is_zeroed(right_idx));
             idx = parent_idx;
         } else {
             tree_nodes[parent_idx].status = STATUS_DIVIDED;
@@ -165,38 +189,287 @@ static int locate_node_for_offset(int idx, uint32_t target_offset) {
     return locate_node_for_offset(right_idx, target_offset);
 }
 
+// Frees every occupied block owned by the given PID in the subtree and merges what became free.
+static int release_owned(int idx, int owner) {
+    TreeNode *node = &tree_nodes[idx];
+
+    if (node->status == STATUS_OCCUPIED) {
+        if (node->owner != owner) {
+            return 0;
+        }
+        int block_size = get_block_size(node->block_order);
+        node->status = STATUS_AVAILABLE;
+        node->owner = MEMORY_KERNEL_OWNER;
+        set_zeroed(idx, 0);
+        internal_fragmentation -= block_size - (int)node->requested;
+        memoryStatsRecordFree(heap + node->offset, MEMORY_STATS_UNTIMED);
+        return block_size;
+    }
+
+    if (node->status != STATUS_DIVIDED) {
+        return 0;
+    }
+
+    int left_idx = (idx * 2) + 1;
+    int right_idx = left_idx + 1;
+    if (right_idx >= TOTAL_NODES) {
+        return 0;
+    }
+
+    int released = release_owned(left_idx, owner) + release_owned(right_idx, owner);
+
+    if (tree_nodes[left_idx].status == STATUS_AVAILABLE && tree_nodes[right_idx].status == STATUS_AVAILABLE) {
+        node->status = STATUS_AVAILABLE;
+        set_zeroed(idx, is_zeroed(left_idx) && is_zeroed(right_idx));
+    }
+
+    return released;
+}
+
+// Adds up the size of every occupied block owned by the given PID in the subtree.
+static int count_owned(int idx, int owner) {
+    TreeNode *node = &tree_nodes[idx];
+
+    if (node->status == STATUS_OCCUPIED) {
+        return (node->owner == owner) ? get_block_size(node->block_order) : 0;
+    }
+
+    if (node->status != STATUS_DIVIDED) {
+        return 0;
+    }
+
+    int left_idx = (idx * 2) + 1;
+    int right_idx = left_idx + 1;
+    if (right_idx >= TOTAL_NODES) {
+        return 0;
+    }
+
+    return count_owned(left_idx, owner) + count_owned(right_idx, owner);
+}
+
+// Counts the free blocks of the subtree per order and tracks the biggest one.
+static void collect_free_blocks(int idx, MemoryStats *stats) {
+    TreeNode *node = &tree_nodes[idx];
+
+    if (node->status == STATUS_AVAILABLE) {
+        int block_size = get_block_size(node->block_order);
+        stats->freeBlocks[memoryStatsBlockClass(block_size)]++;
+        if (block_size > stats->largestFreeBlock) {
+            stats->largestFreeBlock = block_size;
+        }
+        return;
+    }
+
+    if (node->status != STATUS_DIVIDED) {
+        return;
+    }
+
+    int left_idx = (idx * 2) + 1;
+    int right_idx = left_idx + 1;
+    if (right_idx >= TOTAL_NODES) {
+        return;
+    }
+
+    collect_free_blocks(left_idx, stats);
+    collect_free_blocks(right_idx, stats);
+}
+
+// Returns the occupied node that starts at ptr, or -1 if ptr is not a live reservation.
+static int lookup_occupied_node(void *ptr) {
+    uint8_t *ptr_byte = (uint8_t *)ptr;
+    if (ptr_byte < heap || ptr_byte >= heap + TOTAL_HEAP_SIZE) {
+        return -1;
+    }
+
+    int node_index = locate_node_for_offset(0, (uint32_t)(ptr_byte - heap));
+    if (node_index < 0 || node_index >= TOTAL_NODES || tree_nodes[node_index].status != STATUS_OCCUPIED) {
+        return -1;
+    }
+    return node_index;
+}
+
+// Reserves a block of at least the given order, returns its node or -1.
+static int reserve_block(int size, int order, int ownerPid, uint64_t start) {
+    if (size <= 0 || size > TOTAL_HEAP_SIZE || order > MAX_BLOCK_ORDER) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return -1;
+    }
+
+    int allocated_idx = find_and_allocate(0, order);
+    if (allocated_idx < 0) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return -1;
+    }
+
+    TreeNode *allocated_node = &tree_nodes[allocated_idx];
+    allocated_node->owner = (int16_t)ownerPid;
+    allocated_node->requested = (uint32_t)size;
+    int block_size = get_block_size(allocated_node->block_order);
+    total_free_bytes -= block_size;
+    internal_fragmentation += block_size - size;
+    memoryStatsRecordAllocation(heap + allocated_node->offset, size, start);
+
+    return allocated_idx;
+}
+
+// Merges an occupied block with its free buddies until it reaches the given order.
+// Only possible while the block is the left half at every level, returns the new node or -1.
+static int grow_in_place(int idx, int order) {
+    int current = idx;
+    for (int level = tree_nodes[idx].block_order; level < order; level++) {
+        if (current == 0 || (current % 2) == 0 || tree_nodes[current + 1].status != STATUS_AVAILABLE) {
+            return -1;
+        }
+        current = (current - 1) >> 1;
+    }
+
+    TreeNode *old_node = &tree_nodes[idx];
+    TreeNode *new_node = &tree_nodes[current];
+    new_node->status = STATUS_OCCUPIED;
+    new_node->owner = old_node->owner;
+    new_node->requested = old_node->requested;
+
+    // Everything below the grown block goes back to available so the subtree stays consistent
+    for (int node = idx; node != current; node = (node - 1) >> 1) {
+        tree_nodes[node].status = STATUS_AVAILABLE;
+        tree_nodes[node].owner = MEMORY_KERNEL_OWNER;
+    }
+    return current;
+}
+
+// Splits an occupied block until it has the given order, releasing the right halves.
+static int shrink_in_place(int idx, int order) {
+    while (tree_nodes[idx].block_order > order) {
+        TreeNode *node = &tree_nodes[idx];
+        int left_idx = (idx * 2) + 1;
+        int right_idx = left_idx + 1;
+
+        tree_nodes[left_idx].status = STATUS_OCCUPIED;
+        tree_nodes[left_idx].owner = node->owner;
+        tree_nodes[left_idx].requested = node->requested;
+        tree_nodes[right_idx].status = STATUS_AVAILABLE;
+        tree_nodes[right_idx].owner = MEMORY_KERNEL_OWNER;
+        set_zeroed(right_idx, 0);
+        node->status = STATUS_DIVIDED;
+        node->owner = MEMORY_KERNEL_OWNER;
+        idx = left_idx;
+    }
+    return idx;
+}
+
 
 void initMemory(void) {
     build_tree(0, MAX_BLOCK_ORDER, 0);
+    memset(heap, 0, sizeof(heap));
+    memset(zeroed_nodes, 0, sizeof(zeroed_nodes));
+    set_zeroed(0, 1);
     allocator_initialized = 1;
     total_free_bytes = TOTAL_HEAP_SIZE;
+    internal_fragmentation = 0;
+    memoryStatsReset();
 }
 
 void * myMalloc(int size) {
+    return myMallocOwned(size, MEMORY_KERNEL_OWNER);
+}
+
+void * myMallocOwned(int size, int ownerPid) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+
+    uint64_t start = memoryStatsStart();
+    int allocated_idx = reserve_block(size, calculate_order(size), ownerPid, start);
+    return (allocated_idx < 0) ? NULL : heap + tree_nodes[allocated_idx].offset;
+}
+
+void * myCalloc(int count, int size) {
+    return myCallocOwned(count, size, MEMORY_KERNEL_OWNER);
+}
+
+void * myCallocOwned(int count, int size, int ownerPid) {
     if (!allocator_initialized) {
         initMemory();
     }
 
-    if (size <= 0 || size > TOTAL_HEAP_SIZE) {
+    uint64_t start = memoryStatsStart();
+    int total = (count > 0 && size > 0 && count <= TOTAL_HEAP_SIZE / size) ? count * size : -1;
+    int allocated_idx = reserve_block(total, calculate_order(total), ownerPid, start);
+    if (allocated_idx < 0) {
         return NULL;
     }
 
-    int order = calculate_order(size);
+    void *ptr = heap + tree_nodes[allocated_idx].offset;
+    if (!is_zeroed(allocated_idx)) {
+        memset(ptr, 0, (size_t)total);
+    }
+    return ptr;
+}
+
+void * myAlignedAlloc(int alignment, int size) {
+    return myAlignedAllocOwned(alignment, size, MEMORY_KERNEL_OWNER);
+}
 
-    if (order > MAX_BLOCK_ORDER) {
+void * myAlignedAllocOwned(int alignment, int size, int ownerPid) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+    if (alignment <= 0 || alignment > MEMORY_MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
         return NULL;
     }
 
-    int allocated_idx = find_and_allocate(0, order);
-    if (allocated_idx < 0) {
+    // Blocks are aligned to their own size, so asking for a block at least as big as the alignment is enough
+    uint64_t start = memoryStatsStart();
+    int order = calculate_order(size > alignment ? size : alignment);
+    int allocated_idx = reserve_block(size, order, ownerPid, start);
+    return (allocated_idx < 0) ? NULL : heap + tree_nodes[allocated_idx].offset;
+}
+
+void * myRealloc(void *ptr, int size) {
+    if (ptr == NULL) {
+        return myMalloc(size);
+    }
+    if (size <= 0) {
+        myFree(ptr);
+        return NULL;
+    }
+    if (!allocator_initialized) {
         return NULL;
     }
 
-    TreeNode *allocated_node = &tree_nodes[allocated_idx];
-    int block_size = get_block_size(allocated_node->block_order);
-    total_free_bytes -= block_size;
+    int node_index = lookup_occupied_node(ptr);
+    int order = calculate_order(size);
+    if (node_index < 0 || order > MAX_BLOCK_ORDER) {
+        return NULL;
+    }
+
+    TreeNode *node = &tree_nodes[node_index];
+    int old_block_size = get_block_size(node->block_order);
+    int old_requested = (int)node->requested;
+
+    int resized_index = -1;
+    if (order <= node->block_order) {
+        resized_index = shrink_in_place(node_index, order);
+    } else {
+        resized_index = grow_in_place(node_index, order);
+    }
+
+    if (resized_index >= 0) {
+        TreeNode *resized = &tree_nodes[resized_index];
+        int block_size = get_block_size(resized->block_order);
+        resized->requested = (uint32_t)size;
+        total_free_bytes += old_block_size - block_size;
+        internal_fragmentation += (block_size - size) - (old_block_size - old_requested);
+        return ptr;
+    }
 
-    return heap + allocated_node->offset;
+    void *moved = myMallocOwned(size, node->owner);
+    if (moved == NULL) {
+        return NULL;
+    }
+    memcpy(moved, ptr, (size_t)(old_requested < size ? old_requested : size));
+    myFree(ptr);
+    return moved;
 }
 
 void myFree(void *ptr) {
@@ -208,29 +481,31 @@ void myFree(void *ptr) {
         return;
     }
 
-    uint8_t *ptr_byte = (uint8_t *)ptr;
-    uint8_t *heap_start = heap;
-    uint8_t *heap_end = heap + TOTAL_HEAP_SIZE;
-
-    if (ptr_byte < heap_start || ptr_byte >= heap_end) {
-        return;
-    }
-
-    uint32_t offset = (uint32_t)(ptr_byte - heap_start);
-    int node_index = locate_node_for_offset(0, offset);
-    if (node_index < 0 || node_index >= TOTAL_NODES) {
+    uint64_t start = memoryStatsStart();
+    int node_index = lookup_occupied_node(ptr);
+    if (node_index < 0) {
         return;
     }
 
     TreeNode *node_to_free = &tree_nodes[node_index];
+    int block_size = get_block_size(node_to_free->block_order);
+    node_to_free->status = STATUS_AVAILABLE;
+    node_to_free->owner = MEMORY_KERNEL_OWNER;
+    set_zeroed(node_index, 0);
+    total_free_bytes += block_size;
+    internal_fragmentation -= block_size - (int)node_to_free->requested;
+    memoryStatsRecordFree(ptr, start);
+    merge_upwards(node_index);
+}
 
-    if (node_to_free->status != STATUS_OCCUPIED) {
-        return;
+int myFreeOwnedBy(int ownerPid) {
+    if (!allocator_initialized || ownerPid == MEMORY_KERNEL_OWNER) {
+        return 0;
     }
 
-    node_to_free->status = STATUS_AVAILABLE;
-    total_free_bytes += get_block_size(node_to_free->block_order);
-    merge_upwards(node_index);
+    int released = release_owned(0, ownerPid);
+    total_free_bytes += released;
+    return released;
 }
 
 void memstats(int *total, int *used, int *available) {
@@ -249,6 +524,45 @@ void memstats(int *total, int *used, int *available) {
     }
 }
 
+void memstatsExtended(MemoryStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (!allocator_initialized) {
+        initMemory();
+    }
+
+    memstats(&stats->total, &stats->used, &stats->available);
+    memoryStatsFill(stats);
+    stats->internalFragmentation = internal_fragmentation;
+    stats->largestFreeBlock = 0;
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        stats->freeBlocks[i] = 0;
+    }
+    collect_free_blocks(0, stats);
+}
+
+int memstatsOwner(int ownerPid) {
+    if (!allocator_initialized) {
+        return 0;
+    }
+    return count_owned(0, ownerPid);
+}
+
+int memstatsBlock(void *ptr, int *ownerPid) {
+    if (ptr == NULL || !allocator_initialized) {
+        return 0;
+    }
+    int node_index = lookup_occupied_node(ptr);
+    if (node_index < 0) {
+        return 0;
+    }
+    if (ownerPid != NULL) {
+        *ownerPid = tree_nodes[node_index].owner;
+    }
+    return get_block_size(tree_nodes[node_index].block_order);
+}
+
 int isValidHeapPtr(void *ptr) {
     if (ptr == NULL) {
         return 0;
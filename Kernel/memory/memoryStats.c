@@ -0,0 +1,146 @@
+#include "memoryStats.h"
+#include <lib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static uint32_t allocation_count = 0;
+static uint32_t free_count = 0;
+static uint32_t failed_count = 0;
+static uint32_t request_sizes[MEMORY_STATS_CLASSES];
+static uint64_t max_malloc_cycles = 0;
+static uint64_t max_free_cycles = 0;
+static uint64_t malloc_cycles = 0;
+static uint64_t free_cycles = 0;
+
+#ifdef MEMORY_TRACE
+// Every request is written to the QEMU debug console (port 0xE9) as one line the host
+// benchmark can replay: "a <size> <ptr>" for allocations (ptr 0 when they fail) and "f <ptr>" for frees.
+#define MEMORY_TRACE_PORT 0xE9
+
+static void trace_char(char c) {
+    _outb(MEMORY_TRACE_PORT, (uint8_t)c);
+}
+
+static void trace_hex(uint64_t value) {
+    char digits[16];
+    int count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    while (count > 0) {
+        trace_char(digits[--count]);
+    }
+}
+
+static void trace_allocation(void *ptr, int requested) {
+    trace_char('a');
+    trace_char(' ');
+    trace_hex((uint64_t)(uint32_t)requested);
+    trace_char(' ');
+    trace_hex((uint64_t)ptr);
+    trace_char('\n');
+}
+
+static void trace_free(void *ptr) {
+    trace_char('f');
+    trace_char(' ');
+    trace_hex((uint64_t)ptr);
+    trace_char('\n');
+}
+#endif
+
+int memoryStatsRequestClass(int size) {
+    int class = 0;
+    int class_size = MEMORY_STATS_MIN_CLASS_SIZE;
+
+    while (class < MEMORY_STATS_CLASSES - 1 && class_size < size) {
+        class_size <<= 1;
+        class++;
+    }
+    return class;
+}
+
+int memoryStatsBlockClass(int size) {
+    int class = 0;
+    int class_size = MEMORY_STATS_MIN_CLASS_SIZE;
+
+    while (class < MEMORY_STATS_CLASSES - 1 && (class_size << 1) <= size) {
+        class_size <<= 1;
+        class++;
+    }
+    return class;
+}
+
+void memoryStatsReset(void) {
+    allocation_count = 0;
+    free_count = 0;
+    failed_count = 0;
+    max_malloc_cycles = 0;
+    max_free_cycles = 0;
+    malloc_cycles = 0;
+    free_cycles = 0;
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        request_sizes[i] = 0;
+    }
+}
+
+uint64_t memoryStatsStart(void) {
+    return _rdtsc();
+}
+
+void memoryStatsRecordAllocation(void *ptr, int requested, uint64_t startCycles) {
+    if (startCycles != MEMORY_STATS_UNTIMED) {
+        uint64_t elapsed = _rdtsc() - startCycles;
+        malloc_cycles += elapsed;
+        if (elapsed > max_malloc_cycles) {
+            max_malloc_cycles = elapsed;
+        }
+    }
+
+    if (requested > 0) {
+        request_sizes[memoryStatsRequestClass(requested)]++;
+    }
+
+    if (ptr != NULL) {
+        allocation_count++;
+    } else {
+        failed_count++;
+    }
+
+#ifdef MEMORY_TRACE
+    trace_allocation(ptr, requested);
+#endif
+}
+
+void memoryStatsRecordFree(void *ptr, uint64_t startCycles) {
+    if (startCycles != MEMORY_STATS_UNTIMED) {
+        uint64_t elapsed = _rdtsc() - startCycles;
+        free_cycles += elapsed;
+        if (elapsed > max_free_cycles) {
+            max_free_cycles = elapsed;
+        }
+    }
+    free_count++;
+
+#ifdef MEMORY_TRACE
+    trace_free(ptr);
+#endif
+}
+
+void memoryStatsFill(MemoryStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->allocationCount = allocation_count;
+    stats->freeCount = free_count;
+    stats->failedCount = failed_count;
+    stats->maxMallocCycles = max_malloc_cycles;
+    stats->maxFreeCycles = max_free_cycles;
+    stats->mallocCycles = malloc_cycles;
+    stats->freeCycles = free_cycles;
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        stats->requestSizes[i] = request_sizes[i];
+    }
+}
@@ -0,0 +1,647 @@
+
+
+#include "memory.h"
+#include "memoryStats.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Two-Level Segregated Fit allocator: free blocks are kept in size-segregated lists indexed by a
+// first level (power of two) and a second level (linear subdivision of that power of two).
+// Two bitmaps record which lists are non-empty, so malloc and free run in constant time.
+
+#define HEAP_SIZE (4096 * 128)  // 512K Heap
+
+#define ALIGN_SIZE_LOG2 3
+#define ALIGN_SIZE (1u << ALIGN_SIZE_LOG2)
+
+#define SL_INDEX_COUNT_LOG2 4
+#define SL_INDEX_COUNT (1u << SL_INDEX_COUNT_LOG2)
+#define FL_INDEX_MAX 19                                      // Blocks are always smaller than the 512K heap
+#define FL_INDEX_SHIFT (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define FL_INDEX_COUNT (FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE (1u << FL_INDEX_SHIFT)               // Sizes below this map linearly into the first list
+
+#define BLOCK_FREE_BIT 0x1u
+#define BLOCK_ZEROED_BIT 0x2u   // Free block whose payload past the list links is known to be all zeros
+#define BLOCK_SIZE_MASK (~(ALIGN_SIZE - 1))
+
+typedef struct BlockHeader {
+    struct BlockHeader *prev_physical;  // Block right before this one in the heap (NULL for the first one)
+    uint32_t size;                      // Payload bytes, the low bits hold the flags
+    int16_t owner;                      // PID the block was reserved for (only meaningful when used)
+    uint16_t slack;                     // Payload bytes past the request (only meaningful when used)
+    struct BlockHeader *next_free;      // Free list links, they overlap the payload so only exist while free
+    struct BlockHeader *prev_free;
+} BlockHeader;
+
+#define BLOCK_OVERHEAD (offsetof(BlockHeader, next_free))
+#define BLOCK_MIN_PAYLOAD (sizeof(BlockHeader) - BLOCK_OVERHEAD)
+#define BLOCK_MIN_SPLIT (sizeof(BlockHeader))                    // Smallest remainder worth turning into a block
+#define BLOCK_MAX_PAYLOAD (HEAP_SIZE - BLOCK_OVERHEAD - sizeof(BlockHeader))  // Leaves a whole header for the sentinel
+#define BLOCK_START_BITS (HEAP_SIZE / ALIGN_SIZE)
+
+static uint8_t heap[HEAP_SIZE] __attribute__((aligned(MEMORY_MAX_ALIGNMENT)));
+
+static uint32_t fl_bitmap;
+static uint32_t sl_bitmap[FL_INDEX_COUNT];
+static BlockHeader *free_lists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+static uint64_t block_starts[BLOCK_START_BITS / 64];  // Marks the heap offsets where a block header lives
+
+static int allocator_initialized = 0;
+static int used_bytes = 0;
+static int internal_fragmentation = 0;
+
+
+// ========== Helper Functions ==========
+// Index of the least significant set bit (word must not be 0).
+static int ffs_bit(uint32_t word) {
+    return __builtin_ctz(word);
+}
+
+// Index of the most significant set bit (word must not be 0).
+static int fls_bit(uint32_t word) {
+    return 31 - __builtin_clz(word);
+}
+
+static uint32_t block_size(const BlockHeader *block) {
+    return block->size & BLOCK_SIZE_MASK;
+}
+
+static int block_is_free(const BlockHeader *block) {
+    return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+static void block_set_size(BlockHeader *block, uint32_t size) {
+    block->size = size | (block->size & ~BLOCK_SIZE_MASK);
+}
+
+static void block_set_free(BlockHeader *block, int is_free) {
+    block->size = is_free ? (block->size | BLOCK_FREE_BIT) : (block->size & ~BLOCK_FREE_BIT);
+}
+
+static int block_is_zeroed(const BlockHeader *block) {
+    return (block->size & BLOCK_ZEROED_BIT) != 0;
+}
+
+static void block_set_zeroed(BlockHeader *block, int is_zeroed) {
+    block->size = is_zeroed ? (block->size | BLOCK_ZEROED_BIT) : (block->size & ~BLOCK_ZEROED_BIT);
+}
+
+static void *block_to_ptr(BlockHeader *block) {
+    return (uint8_t *)block + BLOCK_OVERHEAD;
+}
+
+static BlockHeader *ptr_to_block(void *ptr) {
+    return (BlockHeader *)((uint8_t *)ptr - BLOCK_OVERHEAD);
+}
+
+static BlockHeader *block_next(BlockHeader *block) {
+    return (BlockHeader *)((uint8_t *)block_to_ptr(block) + block_size(block));
+}
+
+// The last header of the heap is a zero-sized used block that stops merges and walks.
+static int block_is_sentinel(const BlockHeader *block) {
+    return block_size(block) == 0;
+}
+
+static uint32_t block_start_bit(const BlockHeader *block) {
+    return (uint32_t)((const uint8_t *)block - heap) / ALIGN_SIZE;
+}
+
+static void mark_block_start(BlockHeader *block, int is_start) {
+    uint32_t bit = block_start_bit(block);
+    if (is_start) {
+        block_starts[bit / 64] |= (1ull << (bit % 64));
+    } else {
+        block_starts[bit / 64] &= ~(1ull << (bit % 64));
+    }
+}
+
+static int is_block_start(const BlockHeader *block) {
+    uint32_t bit = block_start_bit(block);
+    return (block_starts[bit / 64] >> (bit % 64)) & 1;
+}
+
+static uint32_t align_up(uint32_t size) {
+    return (size + (ALIGN_SIZE - 1)) & BLOCK_SIZE_MASK;
+}
+
+// Maps a block size to the list it belongs to.
+static void mapping_insert(uint32_t size, int *fl, int *sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+        return;
+    }
+
+    int first = fls_bit(size);
+    *sl = (int)((size >> (first - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT);
+    *fl = first - (FL_INDEX_SHIFT - 1);
+}
+
+// Maps a request to the first list whose blocks are all big enough to hold it.
+static void mapping_search(uint32_t size, int *fl, int *sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += (1u << (fls_bit(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static void remove_free_block(BlockHeader *block, int fl, int sl) {
+    BlockHeader *prev = block->prev_free;
+    BlockHeader *next = block->next_free;
+
+    if (next != NULL) {
+        next->prev_free = prev;
+    }
+    if (prev != NULL) {
+        prev->next_free = next;
+    }
+
+    if (free_lists[fl][sl] == block) {
+        free_lists[fl][sl] = next;
+        if (next == NULL) {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0) {
+                fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+static void insert_free_block(BlockHeader *block, int fl, int sl) {
+    BlockHeader *head = free_lists[fl][sl];
+    block->next_free = head;
+    block->prev_free = NULL;
+    if (head != NULL) {
+        head->prev_free = block;
+    }
+    free_lists[fl][sl] = block;
+    fl_bitmap |= (1u << fl);
+    sl_bitmap[fl] |= (1u << sl);
+}
+
+static void block_remove(BlockHeader *block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(block, fl, sl);
+}
+
+static void block_insert(BlockHeader *block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(block, fl, sl);
+}
+
+// Finds a non-empty list at or above (fl, sl) using the bitmaps.
+static BlockHeader *search_suitable_block(int *fl, int *sl) {
+    uint32_t sl_map = sl_bitmap[*fl] & (~0u << *sl);
+    if (sl_map == 0) {
+        uint32_t fl_map = (*fl + 1 < 32) ? (fl_bitmap & (~0u << (*fl + 1))) : 0;
+        if (fl_map == 0) {
+            return NULL;
+        }
+        *fl = ffs_bit(fl_map);
+        sl_map = sl_bitmap[*fl];
+    }
+    *sl = ffs_bit(sl_map);
+    return free_lists[*fl][*sl];
+}
+
+// Fallback when no list guarantees a fit: the list the size maps to may still hold a block big enough.
+// Only its head is tried, so allocation stays constant time; a fit further down that list is given up,
+// the waste the rounding up of mapping_search accepts in exchange.
+static BlockHeader *search_exact_list(uint32_t size, int *fl, int *sl) {
+    mapping_insert(size, fl, sl);
+    BlockHeader *block = free_lists[*fl][*sl];
+    return (block != NULL && block_size(block) >= size) ? block : NULL;
+}
+
+// Splits the tail of a block into a new free block when it is big enough to be useful.
+static void block_trim(BlockHeader *block, uint32_t size) {
+    if (block_size(block) < size + BLOCK_MIN_SPLIT) {
+        return;
+    }
+
+    BlockHeader *remaining = (BlockHeader *)((uint8_t *)block_to_ptr(block) + size);
+    remaining->size = 0;
+    block_set_size(remaining, block_size(block) - size - BLOCK_OVERHEAD);
+    block_set_free(remaining, 1);
+    block_set_zeroed(remaining, block_is_zeroed(block));
+    remaining->prev_physical = block;
+    remaining->owner = MEMORY_KERNEL_OWNER;
+    remaining->slack = 0;
+    mark_block_start(remaining, 1);
+    block_next(remaining)->prev_physical = remaining;
+
+    block_set_size(block, size);
+    block_insert(remaining);
+}
+
+// Absorbs next into block, next must be physically adjacent.
+// One side is always memory that was in use, so the result is never known to be zeroed.
+static void block_absorb(BlockHeader *block, BlockHeader *next) {
+    mark_block_start(next, 0);
+    block_set_zeroed(block, 0);
+    block_set_size(block, block_size(block) + block_size(next) + BLOCK_OVERHEAD);
+    block_next(block)->prev_physical = block;
+}
+
+// Merges a free block that is not in any list with the free block after it, if there is one.
+static void merge_with_next(BlockHeader *block) {
+    BlockHeader *next = block_next(block);
+    if (!block_is_sentinel(next) && block_is_free(next)) {
+        block_remove(next);
+        block_absorb(block, next);
+    }
+}
+
+// Marks a used block as free, merges it with its free neighbours and returns the resulting block.
+static BlockHeader *release_block(BlockHeader *block) {
+    used_bytes -= (int)block_size(block);
+    internal_fragmentation -= block->slack;
+    block->slack = 0;
+    block->owner = MEMORY_KERNEL_OWNER;
+    block_set_free(block, 1);
+    block_set_zeroed(block, 0);
+    merge_with_next(block);
+
+    BlockHeader *prev = block->prev_physical;
+    if (prev != NULL && block_is_free(prev)) {
+        block_remove(prev);
+        block_absorb(prev, block);
+        block = prev;
+    }
+
+    block_insert(block);
+    return block;
+}
+
+static BlockHeader *first_block(void) {
+    return (BlockHeader *)heap;
+}
+
+// Validates the pointer without walking the heap: it must be the payload of a used block.
+static BlockHeader *lookup_used_block(void *ptr) {
+    uint8_t *ptr_byte = (uint8_t *)ptr;
+
+    if (ptr_byte < heap + BLOCK_OVERHEAD || ptr_byte >= heap + HEAP_SIZE) {
+        return NULL;
+    }
+
+    if (((uintptr_t)ptr_byte - (uintptr_t)heap) % ALIGN_SIZE != 0) {
+        return NULL;
+    }
+
+    BlockHeader *block = ptr_to_block(ptr);
+    if (!is_block_start(block) || block_is_free(block) || block_is_sentinel(block)) {
+        return NULL;
+    }
+    return block;
+}
+
+static uint32_t adjust_request(int size) {
+    uint32_t adjusted = align_up((uint32_t)size);
+    return (adjusted < BLOCK_MIN_PAYLOAD) ? BLOCK_MIN_PAYLOAD : adjusted;
+}
+
+// Takes a free block of at least size bytes out of its list, or returns NULL.
+static BlockHeader *take_free_block(uint32_t size) {
+    int fl, sl;
+    mapping_search(size, &fl, &sl);
+    BlockHeader *block = (fl < FL_INDEX_COUNT) ? search_suitable_block(&fl, &sl) : NULL;
+    if (block == NULL) {
+        block = search_exact_list(size, &fl, &sl);
+    }
+    if (block != NULL) {
+        remove_free_block(block, fl, sl);
+    }
+    return block;
+}
+
+// Splits the head of a free block so the payload of the rest starts at an aligned address.
+// The head stays in the free lists, returns the block that starts aligned.
+static BlockHeader *block_trim_front(BlockHeader *block, uint32_t alignment) {
+    uintptr_t payload = (uintptr_t)block_to_ptr(block);
+    uintptr_t aligned = (payload + alignment - 1) & ~((uintptr_t)alignment - 1);
+    while (aligned != payload && aligned - payload < BLOCK_MIN_SPLIT) {
+        aligned += alignment;   // The head must be big enough to be a block of its own
+    }
+    if (aligned == payload) {
+        return block;
+    }
+
+    uint32_t gap = (uint32_t)(aligned - payload);
+    BlockHeader *aligned_block = ptr_to_block((void *)aligned);
+    aligned_block->size = 0;
+    block_set_size(aligned_block, block_size(block) - gap);
+    block_set_free(aligned_block, 1);
+    block_set_zeroed(aligned_block, block_is_zeroed(block));
+    aligned_block->prev_physical = block;
+    aligned_block->owner = MEMORY_KERNEL_OWNER;
+    aligned_block->slack = 0;
+    mark_block_start(aligned_block, 1);
+    block_next(aligned_block)->prev_physical = aligned_block;
+
+    block_set_size(block, gap - BLOCK_OVERHEAD);
+    block_insert(block);
+    return aligned_block;
+}
+
+// Hands a free block out of the lists to its owner, trimming what the request does not need.
+static void *use_block(BlockHeader *block, int size, int ownerPid, uint64_t start) {
+    block_trim(block, adjust_request(size));
+    block_set_free(block, 0);
+    block_set_zeroed(block, 0);
+    block->owner = (int16_t)ownerPid;
+    block->slack = (uint16_t)(block_size(block) - (uint32_t)size);
+
+    used_bytes += (int)block_size(block);
+    internal_fragmentation += block->slack;
+    void *ptr = block_to_ptr(block);
+    memoryStatsRecordAllocation(ptr, size, start);
+    return ptr;
+}
+
+
+void initMemory(void) {
+    fl_bitmap = 0;
+    for (int fl = 0; fl < FL_INDEX_COUNT; fl++) {
+        sl_bitmap[fl] = 0;
+        for (int sl = 0; sl < SL_INDEX_COUNT; sl++) {
+            free_lists[fl][sl] = NULL;
+        }
+    }
+    for (uint32_t i = 0; i < BLOCK_START_BITS / 64; i++) {
+        block_starts[i] = 0;
+    }
+
+    memset(heap, 0, sizeof(heap));
+
+    BlockHeader *block = first_block();
+    block->prev_physical = NULL;
+    block->size = 0;
+    block_set_size(block, BLOCK_MAX_PAYLOAD);
+    block_set_free(block, 1);
+    block_set_zeroed(block, 1);
+    block->owner = MEMORY_KERNEL_OWNER;
+    block->slack = 0;
+    mark_block_start(block, 1);
+
+    BlockHeader *sentinel = block_next(block);
+    sentinel->prev_physical = block;
+    sentinel->size = 0;
+    sentinel->owner = MEMORY_KERNEL_OWNER;
+    sentinel->slack = 0;
+    mark_block_start(sentinel, 1);
+
+    block_insert(block);
+
+    allocator_initialized = 1;
+    used_bytes = 0;
+    internal_fragmentation = 0;
+    memoryStatsReset();
+}
+
+void * myMalloc(int size) {
+    return myMallocOwned(size, MEMORY_KERNEL_OWNER);
+}
+
+void * myMallocOwned(int size, int ownerPid) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+
+    uint64_t start = memoryStatsStart();
+
+    if (size <= 0 || (uint32_t)size > BLOCK_MAX_PAYLOAD) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NULL;
+    }
+
+    BlockHeader *block = take_free_block(adjust_request(size));
+    if (block == NULL) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NULL;
+    }
+
+    return use_block(block, size, ownerPid, start);
+}
+
+void * myCalloc(int count, int size) {
+    return myCallocOwned(count, size, MEMORY_KERNEL_OWNER);
+}
+
+void * myCallocOwned(int count, int size, int ownerPid) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+
+    uint64_t start = memoryStatsStart();
+    int total = (count > 0 && size > 0 && count <= (int)BLOCK_MAX_PAYLOAD / size) ? count * size : -1;
+    BlockHeader *block = (total > 0) ? take_free_block(adjust_request(total)) : NULL;
+    if (block == NULL) {
+        memoryStatsRecordAllocation(NULL, total, start);
+        return NULL;
+    }
+
+    // A zeroed block only has the free list links to clear
+    int dirty_bytes = (block_is_zeroed(block) && total > (int)BLOCK_MIN_PAYLOAD) ? (int)BLOCK_MIN_PAYLOAD : total;
+    void *ptr = use_block(block, total, ownerPid, start);
+    memset(ptr, 0, (size_t)dirty_bytes);
+    return ptr;
+}
+
+void * myAlignedAlloc(int alignment, int size) {
+    return myAlignedAllocOwned(alignment, size, MEMORY_KERNEL_OWNER);
+}
+
+void * myAlignedAllocOwned(int alignment, int size, int ownerPid) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+    if (alignment <= 0 || alignment > MEMORY_MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0) {
+        return NULL;
+    }
+
+    uint64_t start = memoryStatsStart();
+    if (size <= 0 || (uint32_t)size > BLOCK_MAX_PAYLOAD) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NULL;
+    }
+
+    // Room for the worst misalignment plus a head big enough to be split off
+    uint32_t padding = ((uint32_t)alignment > ALIGN_SIZE) ? (uint32_t)alignment + BLOCK_MIN_SPLIT : 0;
+    BlockHeader *block = take_free_block(adjust_request(size) + padding);
+    if (block == NULL) {
+        memoryStatsRecordAllocation(NULL, size, start);
+        return NULL;
+    }
+
+    block = block_trim_front(block, (uint32_t)alignment);
+    return use_block(block, size, ownerPid, start);
+}
+
+void * myRealloc(void *ptr, int size) {
+    if (ptr == NULL) {
+        return myMalloc(size);
+    }
+    if (size <= 0) {
+        myFree(ptr);
+        return NULL;
+    }
+
+    BlockHeader *block = lookup_used_block(ptr);
+    if (block == NULL || (uint32_t)size > BLOCK_MAX_PAYLOAD) {
+        return NULL;
+    }
+
+    uint32_t adjusted = adjust_request(size);
+    uint32_t old_size = block_size(block);
+    BlockHeader *next = block_next(block);
+    int grows_in_place = !block_is_sentinel(next) && block_is_free(next) &&
+                         old_size + BLOCK_OVERHEAD + block_size(next) >= adjusted;
+
+    if (adjusted > old_size && !grows_in_place) {
+        void *moved = myMallocOwned(size, block->owner);
+        if (moved == NULL) {
+            return NULL;
+        }
+        int old_requested = (int)(old_size - block->slack);
+        memcpy(moved, ptr, (size_t)(old_requested < size ? old_requested : size));
+        myFree(ptr);
+        return moved;
+    }
+
+    if (adjusted > old_size) {
+        block_remove(next);
+        block_absorb(block, next);
+    }
+
+    // The tail left over is merged with the free block after it so no two free blocks touch
+    block_trim(block, adjusted);
+    next = block_next(block);
+    if (block_is_free(next)) {
+        block_remove(next);
+        merge_with_next(next);
+        block_insert(next);
+    }
+
+    used_bytes += (int)block_size(block) - (int)old_size;
+    internal_fragmentation -= block->slack;
+    block->slack = (uint16_t)(block_size(block) - (uint32_t)size);
+    internal_fragmentation += block->slack;
+    return ptr;
+}
+
+void myFree(void *ptr) {
+    if (ptr == NULL || !allocator_initialized) {
+        return;
+    }
+
+    uint64_t start = memoryStatsStart();
+    BlockHeader *block = lookup_used_block(ptr);
+    if (block == NULL) {
+        return;
+    }
+
+    release_block(block);
+    memoryStatsRecordFree(ptr, start);
+}
+
+int myFreeOwnedBy(int ownerPid) {
+    if (!allocator_initialized || ownerPid == MEMORY_KERNEL_OWNER) {
+        return 0;
+    }
+
+    int released = 0;
+    BlockHeader *block = first_block();
+    while (!block_is_sentinel(block)) {
+        if (!block_is_free(block) && block->owner == ownerPid) {
+            released += (int)block_size(block);
+            memoryStatsRecordFree(block_to_ptr(block), MEMORY_STATS_UNTIMED);
+            block = release_block(block);
+        }
+        block = block_next(block);
+    }
+    return released;
+}
+
+void memstats(int *total, int *used, int *available) {
+    if (!allocator_initialized) {
+        initMemory();
+    }
+    if (total != NULL) {
+        *total = HEAP_SIZE;
+    }
+    if (used != NULL) {
+        *used = used_bytes;
+    }
+    if (available != NULL) {
+        *available = HEAP_SIZE - used_bytes;
+    }
+}
+
+void memstatsExtended(MemoryStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    if (!allocator_initialized) {
+        initMemory();
+    }
+
+    memstats(&stats->total, &stats->used, &stats->available);
+    memoryStatsFill(stats);
+    stats->internalFragmentation = internal_fragmentation;
+    stats->largestFreeBlock = 0;
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        stats->freeBlocks[i] = 0;
+    }
+
+    for (BlockHeader *block = first_block(); !block_is_sentinel(block); block = block_next(block)) {
+        if (!block_is_free(block)) {
+            continue;
+        }
+        int size = (int)block_size(block);
+        stats->freeBlocks[memoryStatsBlockClass(size)]++;
+        if (size > stats->largestFreeBlock) {
+            stats->largestFreeBlock = size;
+        }
+    }
+}
+
+int memstatsOwner(int ownerPid) {
+    if (!allocator_initialized) {
+        return 0;
+    }
+
+    int owned = 0;
+    for (BlockHeader *block = first_block(); !block_is_sentinel(block); block = block_next(block)) {
+        if (!block_is_free(block) && block->owner == ownerPid) {
+            owned += (int)block_size(block);
+        }
+    }
+    return owned;
+}
+
+int memstatsBlock(void *ptr, int *ownerPid) {
+    if (ptr == NULL || !allocator_initialized) {
+        return 0;
+    }
+    BlockHeader *block = lookup_used_block(ptr);
+    if (block == NULL) {
+        return 0;
+    }
+    if (ownerPid != NULL) {
+        *ownerPid = block->owner;
+    }
+    return (int)block_size(block);
+}
+
+int isValidHeapPtr(void *ptr) {
+    if (ptr == NULL || !allocator_initialized) {
+        return 0;
+    }
+    return lookup_used_block(ptr) != NULL;
+}
@@ -8,38 +8,38 @@
 #include "process.h"
 #include "lib.h"
 #include "semaphores.h"
+#include "scheduler.h"
+#include "lockStats.h"
 #include "strings.h"
 
 #define FALSE 0
 #define TRUE !FALSE
-#define NEXT_IDX(i) (((i) + 1) % PIPE_BUFFER_SIZE)
+
+#define PIPE_SPLICE_CHUNK 512   // Bytes splicePipe takes per call, they sit on the kernel stack
 
 struct pipeCDT {
     int id;
     int readIndex;
-    int writeIndex;
+    int count;          // Bytes in the ring, the write position is derived from readIndex
     uint8_t buffer[PIPE_BUFFER_SIZE];
-    semADT readSem;
-    semADT writeSem;
+    semADT readSem;     // Readers sleeping on an empty ring, never posted, only woken in bulk
+    semADT writeSem;    // Writers sleeping on a full ring, likewise
     int refCount;
     int closed;
     uint8_t lock;
     int activeOps;
     int readerCount;
     int writerCount;
+    int ownerPid;       // Process charged for the pipe until it is finalized
+    const uint8_t * lent;   // Buffer a writer lent with vmsplice, read in place before the ring gets new data
+    int lentSize;
+    int lentOffset;         // Bytes of the lent buffer already consumed
+    uint64_t lentTicket;    // Bumped per lend, so a lender can tell its buffer was finished
+    int lenderPid;          // Process whose buffer is lent, -1 if none
+    int lendersWaiting;     // Lenders waiting for the ring to drain
 };
 
 static pipeADT * pipes = NULL;
-static int pipeSerial = 0;
-
-// used a static buffer to avoid dynamic allocation in getSemName
-static char semNameBuffer[16];
-static char * getSemName(int serial, char mode) {
-    semNameBuffer[4] = '0' + ((serial / 10) % 10);
-    semNameBuffer[5] = '0' + (serial % 10);
-    semNameBuffer[6] = mode;
-    return semNameBuffer;
-}
 
 void initPipes() {
     pipes = myMalloc(sizeof(pipeADT) * MAX_PIPES);
@@ -47,9 +47,6 @@ void initPipes() {
         panic("Failed to allocate memory for pipes");
     }
 
-    pipeSerial = 0;
-    strcpy(semNameBuffer, "pipeXXY");
-    semNameBuffer[7] = '\0';
     for (int i = 0; i < MAX_PIPES; i++) {
         pipes[i] = NULL;
     }
@@ -61,10 +58,12 @@ static void freePipe(pipeADT pipe) {
     }
     semDestroy(pipe->readSem);
     semDestroy(pipe->writeSem);
+    lockStatsForget(&pipe->lock);
+    resourceAdd(pipe->ownerPid, RESOURCE_PIPES, -1);
     myFree(pipe);
 }
 
-static pipeADT buildPipe(int slot, int serial) {
+static pipeADT buildPipe(int slot) {
     pipeADT newPipe = myMalloc(sizeof(struct pipeCDT));
     if(newPipe == NULL){
         return NULL;
@@ -72,33 +71,41 @@ static pipeADT buildPipe(int slot, int serial) {
 
     newPipe->id = slot;
     newPipe->readIndex = 0;
-   newPipe->writeIndex = 0;
+    newPipe->count = 0;
     newPipe->refCount = 0;
     newPipe->closed = 0;
     newPipe->lock = 0;
     newPipe->activeOps = 0;
     newPipe->readerCount = 0;
     newPipe->writerCount = 0;
-
-    // Initialize semaphores
-    getSemName(serial, 'R');
-    newPipe->readSem = semInit(semNameBuffer, 0);
+    newPipe->ownerPid = -1;
+    newPipe->lent = NULL;
+    newPipe->lentSize = 0;
+    newPipe->lentOffset = 0;
+    newPipe->lentTicket = 0;
+    newPipe->lenderPid = -1;
+    newPipe->lendersWaiting = 0;
+
+    // Anonymous semaphores, nothing else needs to find them by name
+    newPipe->readSem = semCreate(0);
     if(newPipe->readSem == NULL){
         myFree(newPipe);
         return NULL;
     }
-    getSemName(serial, 'W');
-    newPipe->writeSem = semInit(semNameBuffer, PIPE_BUFFER_SIZE);
+    newPipe->writeSem = semCreate(0);
     if(newPipe->writeSem == NULL){
         semDestroy(newPipe->readSem);
         newPipe->readSem = NULL;
         myFree(newPipe);
         return NULL;
     }
+    lockStatsName(&newPipe->lock, LOCK_KIND_SPINLOCK, "pipe");
+    lockStatsName(newPipe->readSem, LOCK_KIND_SEMAPHORE, "pipe read");
+    lockStatsName(newPipe->writeSem, LOCK_KIND_SEMAPHORE, "pipe write");
     return newPipe;
 }
 
-int openPipe() {
+int openPipe(int ownerPid) {
     int slot = -1;
     for (int i = 0; i < MAX_PIPES; i++) {
         if (pipes[i] == NULL) {
@@ -110,12 +117,16 @@ int openPipe() {
         return -1;
     }
 
-    int serial = pipeSerial;
-    pipeADT pipe = buildPipe(slot, serial);
+    if (resourceCharge(ownerPid, RESOURCE_PIPES, 1) != 0) {
+        return -1;
+    }
+
+    pipeADT pipe = buildPipe(slot);
     if(pipe == NULL){
+        resourceAdd(ownerPid, RESOURCE_PIPES, -1);
         return -1;
     }
-    pipeSerial++;
+    pipe->ownerPid = ownerPid;
     pipes[slot] = pipe;
     return pipe->id;
 }
@@ -204,18 +215,21 @@ static int closePipeInternal(pipeADT pipe, PipeEndpointRole role) {
 
     semUnlock(&pipe->lock);
 
+    // Both sides are woken before rescheduling once, not once per waiter
+    int woken = 0;
     if (wakeReaders) {
-        wakeBlocked(pipe->readSem);
+        woken += semWakeAll(pipe->readSem);
     }
     if (wakeWriters) {
-        wakeBlocked(pipe->writeSem);
+        woken += semWakeAll(pipe->writeSem);
     }
 
-    if (remainingRefs > 0) {
-        return 0;
+    if (remainingRefs == 0) {
+        tryFinalizePipe(pipe->id);
+    }
+    if (woken > 0) {
+        yield();
     }
-
-    tryFinalizePipe(pipe->id);
     return 0;
 }
 
@@ -228,10 +242,59 @@ int closePipe(int pipeID) {
     return closePipeInternal(pipe, PIPE_ROLE_NONE);
 }
 
-static int pipeHasData(pipeADT pipe) {
-    return pipe->readIndex != pipe->writeIndex;
+// Points *data at the next contiguous bytes a reader can take, at most size. The lent buffer comes first,
+// a writer can only lend one once the ring is empty.
+static int nextSpan(pipeADT pipe, const uint8_t ** data, int size) {
+    int span;
+    if (pipe->lent != NULL) {
+        *data = pipe->lent + pipe->lentOffset;
+        span = pipe->lentSize - pipe->lentOffset;
+    } else {
+        *data = pipe->buffer + pipe->readIndex;
+        span = PIPE_BUFFER_SIZE - pipe->readIndex;
+        if (span > pipe->count) {
+            span = pipe->count;
+        }
+    }
+    return (span < size) ? span : size;
 }
 
+// Drops the bytes a reader is done with. Sets *wakeWriters on the transitions writers sleep on: a full ring
+// getting space, a lent buffer finished, or the ring draining while a lender waits.
+static void consume(pipeADT pipe, int bytes, int * wakeWriters) {
+    if (pipe->lent != NULL) {
+        pipe->lentOffset += bytes;
+        if (pipe->lentOffset == pipe->lentSize) {
+            pipe->lent = NULL;
+            *wakeWriters = TRUE;
+        }
+        return;
+    }
+    int wasFull = (pipe->count == PIPE_BUFFER_SIZE);
+    pipe->readIndex = (pipe->readIndex + bytes) % PIPE_BUFFER_SIZE;
+    pipe->count -= bytes;
+    if (bytes > 0 && (wasFull || (pipe->count == 0 && pipe->lendersWaiting > 0))) {
+        *wakeWriters = TRUE;
+    }
+}
+
+// Copies as much of buffer as fits into the ring, returns how many bytes went in
+static int ringPut(pipeADT pipe, const uint8_t * buffer, int size) {
+    int space = PIPE_BUFFER_SIZE - pipe->count;
+    int total = (size < space) ? size : space;
+    int writeIndex = (pipe->readIndex + pipe->count) % PIPE_BUFFER_SIZE;
+    int first = PIPE_BUFFER_SIZE - writeIndex;
+    if (first > total) {
+        first = total;
+    }
+    memcpy(pipe->buffer + writeIndex, buffer, first);
+    memcpy(pipe->buffer, buffer + first, total - first);
+    pipe->count += total;
+    return total;
+}
+
+// Returns whatever is buffered, up to size, and only blocks while the pipe is empty and open.
+// Sleeping right after the empty check is safe because syscalls run with interrupts off.
 int readPipe(int pipeID, uint8_t * buffer, int size) {
     pipeADT pipe = getPipe(pipeID);
     if (pipe == NULL || buffer == NULL || size < 0) {
@@ -245,34 +308,26 @@ int readPipe(int pipeID, uint8_t * buffer, int size) {
     pipeEnterOperation(pipe);
     int bytesRead = 0;
 
-    while (bytesRead < size) {
-        if (pipe->closed && !pipeHasData(pipe)) {
-            break;
-        }
-
-        if (wait(pipe->readSem) != 0) {
-            break;
-        }
-
+    while (1) {
         semLock(&pipe->lock);
-        if (!pipeHasData(pipe)) {
-            if (pipe->closed) {
-                semUnlock(&pipe->lock);
-                break;
-            }
-            semUnlock(&pipe->lock);
-            continue;
+        int wakeWriters = FALSE;
+        const uint8_t * data;
+        int span;
+        // Two spans at most when the ring wraps
+        while (bytesRead < size && (span = nextSpan(pipe, &data, size - bytesRead)) > 0) {
+            memcpy(buffer + bytesRead, data, span);
+            consume(pipe, span, &wakeWriters);
+            bytesRead += span;
         }
-
-        buffer[bytesRead] = pipe->buffer[pipe->readIndex];
-        pipe->readIndex = NEXT_IDX(pipe->readIndex);
+        int closed = pipe->closed;
         semUnlock(&pipe->lock);
 
-        if (post(pipe->writeSem) != 0) {
-            panic("Pipe write semaphore failed");
+        if (wakeWriters) {
+            semWakeAll(pipe->writeSem);
+        }
+        if (bytesRead > 0 || closed || wait(pipe->readSem) != 0) {
+            break;
         }
-
-        bytesRead++;
     }
 
     pipeLeaveOperation(pipe);
@@ -280,6 +335,7 @@ int readPipe(int pipeID, uint8_t * buffer, int size) {
     return bytesRead;
 }
 
+// Copies everything, blocking each time the ring fills up, unless the pipe closes first
 int writePipe(int pipeID, uint8_t * buffer, int size) {
     pipeADT pipe = getPipe(pipeID);
     if (pipe == NULL || buffer == NULL || size < 0){
@@ -296,37 +352,241 @@ int writePipe(int pipeID, uint8_t * buffer, int size) {
     int written = 0;
 
     while (written < size) {
+        semLock(&pipe->lock);
         if (pipe->closed) {
+            semUnlock(&pipe->lock);
             break;
         }
+        // A lent buffer must be read before anything written after it
+        int wasEmpty = (pipe->count == 0 && pipe->lent == NULL);
+        if (pipe->lent == NULL) {
+            written += ringPut(pipe, buffer + written, size - written);
+        }
+        semUnlock(&pipe->lock);
 
-        if (wait(pipe->writeSem) != 0) {
+        // Readers only sleep on an empty ring
+        if (wasEmpty) {
+            semWakeAll(pipe->readSem);
+        }
+        if (written < size && wait(pipe->writeSem) != 0) {
             break;
         }
+    }
+
+    pipeLeaveOperation(pipe);
+    tryFinalizePipe(pipeID);
+    return written;
+}
 
+int vmsplicePipe(int pipeID, const uint8_t * buffer, int size) {
+    pipeADT pipe = getPipe(pipeID);
+    Process * current = getCurrentProcess();
+    if (pipe == NULL || buffer == NULL || size < 0 || pipe->closed || current == NULL) {
+        return -1;
+    }
+    if (size == 0) {
+        return 0;
+    }
+
+    pipeEnterOperation(pipe);
+    current->pipe_lending = pipeID;     // Lets removeProcess take the buffer back if the lender dies
+    uint64_t ticket = 0;
+    int moved = 0;
+
+    // Bytes already in the ring or lent by someone else go first
+    semLock(&pipe->lock);
+    pipe->lendersWaiting++;
+    current->pipe_lend_phase = PIPE_LEND_QUEUED;
+    while (!pipe->closed && (pipe->count > 0 || pipe->lent != NULL)) {
+        semUnlock(&pipe->lock);
+        wait(pipe->writeSem);
         semLock(&pipe->lock);
-        if (pipe->closed) {
+    }
+    pipe->lendersWaiting--;
+    current->pipe_lend_phase = PIPE_LEND_DONE;
+    if (!pipe->closed) {
+        current->pipe_lend_phase = PIPE_LEND_LENT;
+        pipe->lent = buffer;
+        pipe->lentSize = size;
+        pipe->lentOffset = 0;
+        pipe->lenderPid = current->pid;
+        ticket = ++pipe->lentTicket;
+    }
+    semUnlock(&pipe->lock);
+
+    if (ticket != 0) {
+        semWakeAll(pipe->readSem);
+
+        // The buffer is still the caller's, so the lend lasts until readers are done with it
+        semLock(&pipe->lock);
+        while (pipe->lentTicket == ticket && pipe->lent != NULL && !pipe->closed) {
             semUnlock(&pipe->lock);
-            if (post(pipe->writeSem) != 0) {
-                panic("Pipe write semaphore failed");
-            }
-            break;
+            wait(pipe->writeSem);
+            semLock(&pipe->lock);
+        }
+        if (pipe->lentTicket == ticket && pipe->lent != NULL) {
+            moved = pipe->lentOffset;
+            pipe->lent = NULL;
+        } else {
+            moved = size;
         }
+        if (pipe->lentTicket == ticket) {
+            pipe->lenderPid = -1;
+        }
+        current->pipe_lend_phase = PIPE_LEND_DONE;
+        semUnlock(&pipe->lock);
+    }
+
+    current->pipe_lending = -1;
+    pipeLeaveOperation(pipe);
+    tryFinalizePipe(pipeID);
+    return moved;
+}
+
+void pipeCancelLend(Process * process) {
+    if (process == NULL || process->pipe_lending < 0) {
+        return;
+    }
+    pipeADT pipe = getPipe(process->pipe_lending);
+    process->pipe_lending = -1;
+    if (pipe == NULL) {
+        return;
+    }
+
+    semLock(&pipe->lock);
+    if (process->pipe_lend_phase == PIPE_LEND_LENT && pipe->lenderPid == process->pid) {
+        // The stack and heap of the lender are about to be freed. The ring is empty while a lend lasts, so
+        // what readers did not take yet is copied there, and whatever does not fit is lost as with a writer
+        // killed halfway through a write.
+        if (pipe->lent != NULL) {
+            const uint8_t * rest = pipe->lent + pipe->lentOffset;
+            int restSize = pipe->lentSize - pipe->lentOffset;
+            pipe->lent = NULL;
+            ringPut(pipe, rest, restSize);
+        }
+        pipe->lenderPid = -1;
+    } else if (process->pipe_lend_phase == PIPE_LEND_QUEUED) {
+        pipe->lendersWaiting--;
+    }
+    process->pipe_lend_phase = PIPE_LEND_DONE;
+    pipe->activeOps--;
+    semUnlock(&pipe->lock);
+
+    semWakeAll(pipe->readSem);
+    semWakeAll(pipe->writeSem);
+    tryFinalizePipe(pipe->id);
+}
+
+int splicePipe(int pipeID, PipeSink sink, void * context, int size) {
+    pipeADT pipe = getPipe(pipeID);
+    if (pipe == NULL || sink == NULL || size < 0) {
+        return -1;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    if (size > PIPE_SPLICE_CHUNK) {
+        size = PIPE_SPLICE_CHUNK;
+    }
 
-        pipe->buffer[pipe->writeIndex] = buffer[written];
-        pipe->writeIndex = NEXT_IDX(pipe->writeIndex);
+    pipeEnterOperation(pipe);
+    uint8_t chunk[PIPE_SPLICE_CHUNK];
+    int taken = 0;
+    int moved = 0;
+
+    while (1) {
+        semLock(&pipe->lock);
+        int wakeWriters = FALSE;
+        const uint8_t * data;
+        int span;
+        // The sink runs without the lock, so the bytes are taken out first. A console sink can turn
+        // interrupts back on when it scrolls, and a lent span may be freed once the lock is dropped.
+        while (taken < size && (span = nextSpan(pipe, &data, size - taken)) > 0) {
+            memcpy(chunk + taken, data, span);
+            consume(pipe, span, &wakeWriters);
+            taken += span;
+        }
+        int closed = pipe->closed;
         semUnlock(&pipe->lock);
 
-        if (post(pipe->readSem) != 0) {
-            panic("Pipe read semaphore failed");
+        if (wakeWriters) {
+            semWakeAll(pipe->writeSem);
         }
+        if (taken > 0 || closed || wait(pipe->readSem) != 0) {
+            break;
+        }
+    }
 
-        written++;
+    if (taken > 0) {
+        moved = sink(context, chunk, taken);
     }
 
     pipeLeaveOperation(pipe);
     tryFinalizePipe(pipeID);
-    return written;
+    return moved;
+}
+
+int splicePipes(int inID, int outID, int size) {
+    pipeADT in = getPipe(inID);
+    pipeADT out = getPipe(outID);
+    if (in == NULL || out == NULL || in == out || size < 0) {
+        return -1;
+    }
+    if (size == 0) {
+        return 0;
+    }
+
+    pipeEnterOperation(in);
+    pipeEnterOperation(out);
+    int moved = 0;
+
+    // Each check is followed by its sleep without a reschedule in between, syscalls run with interrupts off
+    while (1) {
+        if (out->closed) {
+            moved = -1;
+            break;
+        }
+        // A lent buffer in the out pipe must be read before anything spliced after it
+        int room = (out->lent != NULL) ? 0 : PIPE_BUFFER_SIZE - out->count;
+        if (room == 0) {
+            if (wait(out->writeSem) != 0) {
+                break;
+            }
+            continue;
+        }
+
+        semLock(&in->lock);
+        semLock(&out->lock);
+        int wasEmpty = (out->count == 0);
+        int wakeWriters = FALSE;
+        const uint8_t * data;
+        int span;
+        // Straight from one ring (or lent buffer) into the other, two spans at most when the source wraps
+        while (moved < size && moved < room && (span = nextSpan(in, &data, ((size < room) ? size : room) - moved)) > 0) {
+            ringPut(out, data, span);
+            consume(in, span, &wakeWriters);
+            moved += span;
+        }
+        int closed = in->closed;
+        semUnlock(&out->lock);
+        semUnlock(&in->lock);
+
+        if (wakeWriters) {
+            semWakeAll(in->writeSem);
+        }
+        if (moved > 0 && wasEmpty) {
+            semWakeAll(out->readSem);
+        }
+        if (moved > 0 || closed || wait(in->readSem) != 0) {
+            break;
+        }
+    }
+
+    pipeLeaveOperation(out);
+    pipeLeaveOperation(in);
+    tryFinalizePipe(outID);
+    tryFinalizePipe(inID);
+    return moved;
 }
 
 int pipeRetain(int pipeID, PipeEndpointRole role) {
@@ -3,39 +3,59 @@
 #include "process.h"
 #include <lib.h>
 #include "memory.h"
+#include "stackCache.h"
+#include "mutex.h"
+#include "waitQueue.h"
 #include "panic.h"
 #include <string.h>
 #include "scheduler.h"
 #include "interrupts.h"
 
 
+// PIDs are split in a directory index and a leaf slot, leaves are only allocated while they hold a process
+#define PID_LEAF_BITS 6
+#define PID_LEAF_SIZE (1 << PID_LEAF_BITS)
+#define PID_DIRECTORY_SIZE ((MAX_PID + 1) / PID_LEAF_SIZE)
+#define PID_WORDS ((MAX_PID + 1) / 64)
+#define PID_SUMMARY_WORDS ((PID_WORDS + 63) / 64)
+#define REMOVED_HISTORY PROCESS_SNAPSHOT_REMOVED_MAX
+#define STACK_SCAN_GAP 1024      // Paint bytes in a row that end an incremental stack scan, larger unwritten holes are missed
+
+typedef struct pid_leaf {
+    Process * processes[PID_LEAF_SIZE];
+    int count;
+} pid_leaf;
+
 typedef struct pcb_table {
-    Process * processes[MAX_PROCESSES];
+    pid_leaf * leaves[PID_DIRECTORY_SIZE];
+    uint64_t used_pids[PID_WORDS];              // 1 = PID taken
+    uint64_t full_words[PID_SUMMARY_WORDS];     // 1 = the used_pids word has no free PID
     int processesCount;
     int current_pid;
     int foreground_pid;
+    uint64_t generation;                        // Bumped on every change a snapshot reports
+    int removed_pids[REMOVED_HISTORY];          // Ring of the last removals, for delta snapshots
+    uint64_t removed_generations[REMOVED_HISTORY];
+    int removed_next;
+    uint64_t removed_floor;                     // Removals up to this generation may have been forgotten
 } pcb_table;
 
 static pcb_table * PCBTable = NULL;
 
-static Process *terminatedQueue[MAX_PROCESSES];
-static int terminatedCount = 0;
+static Process *terminatedHead = NULL;
 static void * init_shell_entry = NULL;
 static int initProcessMain(void);
 static void cleanupProcessEndpoints(Process *process);
-static int initProcessEndpoints(Process *process, Process *parent);
+static int initProcessEndpoints(Process *process, Process *parent, const SpawnFileAction *actions, int actionCount);
+static void terminateThreads(Process *leader);
+static void exitThread(Process *thread);
 
-static int cmpInt(void *a, void *b) {
-    return *((int *)a) - *((int *)b);
+static int checkValidPid(int pid) {
+    return (pid >= 0 && pid <= MAX_PID);
 }
 
-static void initProcessSem(Process *process) {
-    char semName[16] = "process";
-	semName[7] = '0' + process->pid / 100;
-	semName[8] = '0' + process->pid / 10;
-	semName[9] = '0' + process->pid % 10;
-	semName[10] = '\0';
-	process->wait_sem = semInit(semName, 0);
+static int cmpInt(void *a, void *b) {
+    return *((int *)a) - *((int *)b);
 }
 
 static void cleanupProcessEndpoints(Process *process) {
@@ -54,20 +74,32 @@ static void cleanupProcessEndpoints(Process *process) {
     pipeResetEndpoints(process->fds);
 }
 
-static int initProcessEndpoints(Process *process, Process *parent) {
+// Each fd takes the target of its file action if there is one, the parent's otherwise
+static int initProcessEndpoints(Process *process, Process *parent, const SpawnFileAction *actions, int actionCount) {
     if (process == NULL) {
         return -1;
     }
 
     pipeResetEndpoints(process->fds);
 
-    if (parent == NULL) {
+    if (parent == NULL && actionCount == 0) {
         return 0;
     }
 
     for (int fd = 0; fd < PIPE_FD_COUNT; fd++) {
-        PipeEndpointType type = parent->fds[fd].type;
-        int pipeID = parent->fds[fd].pipeID;
+        PipeEndpointType type = PIPE_ENDPOINT_CONSOLE;
+        int pipeID = -1;
+        if (parent != NULL) {
+            type = parent->fds[fd].type;
+            pipeID = parent->fds[fd].pipeID;
+        }
+        for (int i = 0; i < actionCount; i++) {
+            if (actions[i].fd == fd) {
+                type = actions[i].type;
+                pipeID = actions[i].pipeID;
+            }
+        }
+
         int status;
         if (fd == READ_FD) {
             status = pipeSetReadTarget(process->fds, type, pipeID);
@@ -84,49 +116,214 @@ static int initProcessEndpoints(Process *process, Process *parent) {
 }
 
 static void enqueueTerminatedProcess(Process *process) {
-    if (process == NULL) {
+    if (process == NULL || process->in_terminated_queue) {
         return;
     }
 
-    for (int i = 0; i < terminatedCount; i++) {
-        if (terminatedQueue[i] == process) {
+    process->terminated_next = terminatedHead;
+    process->in_terminated_queue = 1;
+    terminatedHead = process;
+}
+
+// ========== Exit status ==========
+static void recordZombie(Process *parent, int pid, int status) {
+    ZombieRecord *record;
+    if (parent->zombie_count >= PROCESS_MAX_ZOMBIES) {
+        // Nobody waited for the oldest one, its record is reused
+        record = parent->zombies;
+        parent->zombies = record->next;
+        if (parent->zombies == NULL) {
+            parent->zombies_tail = NULL;
+        }
+        parent->zombie_count--;
+    } else {
+        record = myMalloc(sizeof(ZombieRecord));
+        if (record == NULL) {
             return;
         }
     }
 
-    if (terminatedCount >= MAX_PROCESSES) {
-        panic("Terminated process queue overflow");
+    record->pid = pid;
+    record->status = status;
+    record->next = NULL;
+    if (parent->zombies_tail != NULL) {
+        parent->zombies_tail->next = record;
+    } else {
+        parent->zombies = record;
     }
-
-    terminatedQueue[terminatedCount++] = process;
+    parent->zombies_tail = record;
+    parent->zombie_count++;
 }
 
-void processCleanupTerminated(Process *exclude) {
-    if (terminatedCount == 0) {
-        return;
+// Removes the record of the given child, or the oldest one for WAIT_ANY_CHILD. Returns its PID, -1 if there is none.
+static int takeZombie(Process *parent, int pid, int *status) {
+    ZombieRecord **link = &parent->zombies;
+    ZombieRecord *previous = NULL;
+    while (*link != NULL && pid != WAIT_ANY_CHILD && (*link)->pid != pid) {
+        previous = *link;
+        link = &(*link)->next;
+    }
+
+    ZombieRecord *record = *link;
+    if (record == NULL) {
+        return -1;
+    }
+    *link = record->next;
+    if (parent->zombies_tail == record) {
+        parent->zombies_tail = previous;
     }
+    parent->zombie_count--;
 
-    int writeIndex = 0;
+    int found = record->pid;
+    if (status != NULL) {
+        *status = record->status;
+    }
+    myFree(record);
+    return found;
+}
 
-    for (int i = 0; i < terminatedCount; i++) {
-        Process *process = terminatedQueue[i];
-        if (process == NULL) {
+static void freeZombies(Process *process) {
+    while (process->zombies != NULL) {
+        ZombieRecord *record = process->zombies;
+        process->zombies = record->next;
+        myFree(record);
+    }
+    process->zombies_tail = NULL;
+    process->zombie_count = 0;
+}
+
+// Unblocks whoever waits for this child or for any child of the process
+static void wakeChildWaiters(Process *parent, int pid) {
+    Process **link = &parent->child_waiters;
+    while (*link != NULL) {
+        Process *waiter = *link;
+        if (waiter->waiting_for_child != pid && waiter->waiting_for_child != WAIT_ANY_CHILD) {
+            link = &waiter->child_wait_next;
             continue;
         }
+        *link = waiter->child_wait_next;
+        waiter->child_wait_next = NULL;
+        waiter->waiting_for_child = -1;
+        unblock(waiter->pid);
+    }
+}
+
+static void stopWaitingForChild(Process *waiter, Process *parent) {
+    if (waiter->waiting_for_child == -1 || parent == NULL) {
+        return;
+    }
+
+    Process **link = &parent->child_waiters;
+    while (*link != NULL && *link != waiter) {
+        link = &(*link)->child_wait_next;
+    }
+    if (*link == waiter) {
+        *link = waiter->child_wait_next;
+    }
+    waiter->child_wait_next = NULL;
+    waiter->waiting_for_child = -1;
+}
+
+void processCleanupTerminated(Process *exclude) {
+    Process *pending = terminatedHead;
+    terminatedHead = NULL;
+
+    while (pending != NULL) {
+        Process *process = pending;
+        pending = process->terminated_next;
+        process->terminated_next = NULL;
+        process->in_terminated_queue = 0;
 
         if (process == exclude) {
-            terminatedQueue[writeIndex++] = process;
+            enqueueTerminatedProcess(process);
             continue;
         }
 
         removeProcess(process);
     }
+}
+
+void processChanged(Process * process) {
+    if (PCBTable != NULL && process != NULL) {
+        process->changed_generation = ++PCBTable->generation;
+    }
+}
 
-    for (int i = writeIndex; i < terminatedCount; i++) {
-        terminatedQueue[i] = NULL;
+static void recordRemoval(int pid) {
+    int slot = PCBTable->removed_next;
+    if (PCBTable->removed_generations[slot] != 0) {
+        PCBTable->removed_floor = PCBTable->removed_generations[slot];
     }
+    PCBTable->removed_pids[slot] = pid;
+    PCBTable->removed_generations[slot] = ++PCBTable->generation;
+    PCBTable->removed_next = (slot + 1) % REMOVED_HISTORY;
+}
 
-    terminatedCount = writeIndex;
+static void markPidUsed(int pid) {
+    int word = pid / 64;
+    PCBTable->used_pids[word] |= (1ull << (pid % 64));
+    if (PCBTable->used_pids[word] == ~0ull) {
+        PCBTable->full_words[word / 64] |= (1ull << (word % 64));
+    }
+}
+
+static void markPidFree(int pid) {
+    int word = pid / 64;
+    PCBTable->used_pids[word] &= ~(1ull << (pid % 64));
+    PCBTable->full_words[word / 64] &= ~(1ull << (word % 64));
+}
+
+// First used_pids word at or after the given one that still has a free PID, -1 if there is none
+static int findNonFullWord(int from) {
+    for (int summary = from / 64; summary < PID_SUMMARY_WORDS; summary++) {
+        uint64_t candidates = ~PCBTable->full_words[summary];
+        if (summary == from / 64) {
+            candidates &= ~0ull << (from % 64);
+        }
+        if (candidates != 0) {
+            return summary * 64 + __builtin_ctzll(candidates);
+        }
+    }
+    return -1;
+}
+
+static int pcbTableInsert(Process *process) {
+    int pid = process->pid;
+    pid_leaf *leaf = PCBTable->leaves[pid >> PID_LEAF_BITS];
+    if (leaf == NULL) {
+        leaf = myCalloc(1, sizeof(pid_leaf));
+        if (leaf == NULL) {
+            return -1;
+        }
+        PCBTable->leaves[pid >> PID_LEAF_BITS] = leaf;
+    }
+
+    leaf->processes[pid & (PID_LEAF_SIZE - 1)] = process;
+    leaf->count++;
+    markPidUsed(pid);
+    processChanged(process);
+    PCBTable->processesCount++;
+    PCBTable->current_pid = pid;
+    return 0;
+}
+
+static void pcbTableRemove(Process *process) {
+    int pid = process->pid;
+    pid_leaf *leaf = PCBTable->leaves[pid >> PID_LEAF_BITS];
+    if (leaf == NULL || leaf->processes[pid & (PID_LEAF_SIZE - 1)] != process) {
+        return;
+    }
+
+    leaf->processes[pid & (PID_LEAF_SIZE - 1)] = NULL;
+    markPidFree(pid);
+    recordRemoval(pid);
+    if (PCBTable->processesCount > 0) {
+        PCBTable->processesCount--;
+    }
+    if (--leaf->count == 0) {
+        PCBTable->leaves[pid >> PID_LEAF_BITS] = NULL;
+        myFree(leaf);
+    }
 }
 
 int initPCBTable() {
@@ -138,10 +335,22 @@ int initPCBTable() {
     PCBTable->processesCount = 0;
     PCBTable->current_pid = -1;
     PCBTable->foreground_pid = -1;
+    PCBTable->generation = 0;
+    PCBTable->removed_next = 0;
+    PCBTable->removed_floor = 0;
+    for (int i = 0; i < REMOVED_HISTORY; i++) {
+        PCBTable->removed_generations[i] = 0;
+    }
 
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-		PCBTable->processes[i] = NULL;
+    for (int i = 0; i < PID_DIRECTORY_SIZE; i++) {
+		PCBTable->leaves[i] = NULL;
 	}
+    for (int i = 0; i < PID_WORDS; i++) {
+        PCBTable->used_pids[i] = 0;
+    }
+    for (int i = 0; i < PID_SUMMARY_WORDS; i++) {
+        PCBTable->full_words[i] = 0;
+    }
 
     return 0;
 }
@@ -154,7 +363,7 @@ int startInitProcess(void * shellEntryPoint) {
     init_shell_entry = shellEntryPoint;
 
     char * initArgv[] = { "init", NULL };
-    Process * initProcess = createProcess((void *)initProcessMain, 1, initArgv, MID_PRIORITY, -1, 1);
+    Process * initProcess = createProcess((void *)initProcessMain, 1, initArgv, MID_PRIORITY, -1, 1, 0);
     if (initProcess == NULL) {
         return -1;
     }
@@ -163,27 +372,36 @@ int startInitProcess(void * shellEntryPoint) {
 }
 
 
+// Next-fit over the free-PID bitmap: PIDs are handed out in increasing order and only reused
+// after wrapping around, so a freed PID is not recycled while a stale reference may still use it.
 int getNextPid(void) {
-    if(PCBTable->current_pid < 0){  // First PID allocation, Idle process
-        return 0;
-    }
-    
     int start = PCBTable->current_pid + 1;
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        int pid = (start + i) % MAX_PROCESSES;
-        if (PCBTable->processes[pid] == NULL || PCBTable->processes[pid]->stack_base == 0 || PCBTable->processes[pid]->state == PROCESS_STATE_TERMINATED) {
-            return pid;
-        }
+    if (start > MAX_PID) {
+        start = 0;
     }
-    return -1;
+
+    int word = start / 64;
+    uint64_t available = ~PCBTable->used_pids[word] & (~0ull << (start % 64));
+    if (available != 0) {
+        return word * 64 + __builtin_ctzll(available);
+    }
+
+    word = (word + 1 < PID_WORDS) ? findNonFullWord(word + 1) : -1;
+    if (word < 0) {
+        word = findNonFullWord(0);
+    }
+    if (word < 0) {
+        return -1;
+    }
+    return word * 64 + __builtin_ctzll(~PCBTable->used_pids[word]);
 }
 
 int changePriority(int pid, ProcessPriority newPriority) {
-    if (pid < 0 || pid >= MAX_PROCESSES || newPriority < MIN_PRIORITY || newPriority > MAX_PRIORITY) {
+    if (newPriority < MIN_PRIORITY || newPriority > MAX_PRIORITY) {
         return -1;
     }
 
-    Process * process = PCBTable->processes[pid];
+    Process * process = getProcess(pid);
     if (process == NULL) {
         return -1;
     }
@@ -201,11 +419,48 @@ int changePriority(int pid, ProcessPriority newPriority) {
             return -1;
         }
     }
+    processChanged(process);
 
     return 0;
 }
 
-Process * createProcess(void * function, int argc, char ** argv, ProcessPriority priority, int parentID, uint8_t is_background){
+// Rounds a stack size hint up to a power of two inside the supported range
+static int normalizeStackSize(int stackSize) {
+    if (stackSize <= 0) {
+        return PROCESS_STACK_SIZE;
+    }
+    int size = PROCESS_STACK_MIN_SIZE;
+    while (size < stackSize && size < PROCESS_STACK_MAX_SIZE) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// Bytes argv takes at the top of the stack: the pointer array followed by the strings, 16-byte aligned
+static int argvBlockSize(int argc, char ** argv) {
+    int size = sizeof(char *) * (argc + 1);
+    for (int i = 0; i < argc; i++) {
+        size += strlen(argv[i]) + 1;
+    }
+    return (size + 15) & ~15;
+}
+
+// Copies argv right below the end of the stack so it costs no allocations and goes away with the stack
+static char ** packArgv(uint8_t * stack_end, int blockSize, int argc, char ** argv) {
+    char ** packed = (char **) (stack_end - blockSize);
+    char * strings = (char *) (packed + argc + 1);
+    for (int i = 0; i < argc; i++) {
+        int length = strlen(argv[i]) + 1;
+        memcpy(strings, argv[i], length);
+        packed[i] = strings;
+        strings += length;
+    }
+    packed[argc] = NULL;
+    return packed;
+}
+
+static Process * newProcess(void * function, int argc, char ** argv, ProcessPriority priority, int parentID, uint8_t is_background,
+                            int stackSize, const SpawnFileAction * actions, int actionCount){
     if(function == NULL || argc < 0 || priority < 0 || (argc > 0 && argv == NULL)){
         return NULL;
     }
@@ -215,19 +470,31 @@ Process * createProcess(void * function, int argc, char ** argv, ProcessPriority
         return NULL;
     }
 
-    // reserve stack
-    uint8_t * stack_base = myMalloc(PROCESS_STACK_SIZE);
+    // reserve stack, reusing a recently released one when the cache has it
+    stackSize = normalizeStackSize(stackSize);
+    int argvSize = argvBlockSize(argc, argv);
+    if (argvSize > stackSize / 2) {
+        return NULL;    // Leaves at least half of the stack for the process
+    }
+    if (resourceCheckChild(parentID, stackSize) != 0) {
+        return NULL;
+    }
+    uint8_t * stack_base = stackCacheAlloc(stackSize);
     if (stack_base == NULL) {
         return NULL;
     }
+    memset(stack_base, PROCESS_STACK_PAINT, stackSize);
 
     Process * process = myMalloc(sizeof(Process));
+    if (process == NULL && stackCacheFlush() > 0) {
+        process = myMalloc(sizeof(Process));
+    }
     if (process == NULL) {
-        myFree(stack_base);
+        stackCacheFree(stack_base, stackSize);
         return NULL;
     }
 
-    uint8_t * stack_top = stack_base + PROCESS_STACK_SIZE - sizeof(uint64_t); // Stack grows downwards
+    uint8_t * stack_top = stack_base + stackSize - argvSize - sizeof(uint64_t); // Stack grows downwards, below argv
 
     process->pid = pid;
     process->ppid = parentID;
@@ -235,83 +502,76 @@ Process * createProcess(void * function, int argc, char ** argv, ProcessPriority
     process->state = PROCESS_STATE_READY;
     process->argc = argc;
     process->stack_base = stack_base;
+    process->stack_size = stackSize;
     process->rip = function;
     process->argv = NULL;
     process->is_background = is_background;
     process->is_foreground = 0;
     process->waiting_for_child = -1;
+    process->ready_next = NULL;
+    process->ready_prev = NULL;
+    process->ready_queue = -1;
+    process->terminated_next = NULL;
+    process->in_terminated_queue = 0;
+    process->is_thread = 0;
+    process->thread_leader = NULL;
+    process->threads = NULL;
+    process->thread_next = NULL;
+    process->joiner_pid = -1;
+    process->exit_status = PROCESS_EXIT_KILLED;
+    process->zombies = NULL;
+    process->zombies_tail = NULL;
+    process->zombie_count = 0;
+    process->child_waiters = NULL;
+    process->child_wait_next = NULL;
+    process->futex_addr = NULL;
+    process->wait_queue = NULL;
+    process->wait_next = NULL;
+    process->wait_prev = NULL;
+    process->mutexes_held = NULL;
+    process->pipe_lending = -1;
+    process->pipe_lend_phase = PIPE_LEND_DONE;
+    process->stack_untouched = -1;
     process->children = createQueue(cmpInt, sizeof(int));
     if(process->children == NULL){
         myFree(process);
-        myFree(stack_base);
+        stackCacheFree(stack_base, stackSize);
         return NULL;
     }
     Process * parent = NULL;
     if (parentID >= 0) {
         parent = getProcess(parentID);
     }
-    if (initProcessEndpoints(process, parent) != 0) {
+    Process * parentLeader = processGroupLeader(parent);
+    resourceInit(&process->resources, parentLeader == NULL ? NULL : &parentLeader->resources);
+    process->resources.usage[RESOURCE_STACK] = stackSize;
+    if (initProcessEndpoints(process, parent, actions, actionCount) != 0) {
         queueFree(process->children);
         myFree(process);
-        myFree(stack_base);
+        stackCacheFree(stack_base, stackSize);
         return NULL;
     }
-    initProcessSem(process);
-
-    process->argv = (char **) myMalloc(sizeof(char *) * (process->argc + 1));
-    if (process->argv == NULL) {
-        myFree(process);
-        myFree(stack_base);
-        semDestroy(process->wait_sem);
-        queueFree(process->children);
-        cleanupProcessEndpoints(process);
-        return NULL;
-    }
-
-    for (int i = 0; i < argc; i++) {
-        int len = strlen(argv[i]);
-        process->argv[i] = (char *) myMalloc(sizeof(char) * (len + 1));
-        if (process->argv[i] == NULL) {
-            for (int j = 0; j < i; j++) {
-                myFree(process->argv[j]);
-            }
-            myFree(process->argv);
-            myFree(process);
-            myFree(stack_base);
-            semDestroy(process->wait_sem);
-            queueFree(process->children);
-            return NULL;
-        }
-        strcpy(process->argv[i], argv[i]);
-        process->argv[i][len] = '\0';
-    }
-    process->argv[argc] = NULL;
 
+    process->argv = packArgv(stack_base + stackSize, argvSize, argc, argv);
     process->name = (process->argc > 0) ? process->argv[0] : NULL;
 
     uint8_t * initial_rsp = stackInit(stack_top, function, process->argc, process->argv);
     if (initial_rsp == NULL) {
-        for (int i = 0; i < process->argc; i++) {
-            myFree(process->argv[i]);
-        }
-        myFree(process->argv);
-        myFree(process);
-        myFree(stack_base);
-        semDestroy(process->wait_sem);
-        queueFree(process->children);
-        cleanupProcessEndpoints(process);
+        freeProcess(process);
         return NULL;
     }
 
     process->rsp = initial_rsp;
 
     // Add process to the PCB
-    PCBTable->processes[pid] = process;
-    PCBTable->processesCount++;
-    PCBTable->current_pid = pid;
+    if (pcbTableInsert(process) != 0) {
+        freeProcess(process);
+        return NULL;
+    }
 
     int added = addProcessToScheduler(process);
     if (added != 0) {
+        pcbTableRemove(process);
         freeProcess(process);
         return NULL;
     }
@@ -337,6 +597,55 @@ Process * createProcess(void * function, int argc, char ** argv, ProcessPriority
     return process;
 }
 
+Process * createProcess(void * function, int argc, char ** argv, ProcessPriority priority, int parentID, uint8_t is_background, int stackSize){
+    return newProcess(function, argc, argv, priority, parentID, is_background, stackSize, NULL, 0);
+}
+
+Process * spawnProcess(void * function, int argc, char ** argv, int parentID, const SpawnAttributes * attributes) {
+    if (attributes == NULL || attributes->actionCount < 0 || attributes->actionCount > SPAWN_MAX_FILE_ACTIONS) {
+        return NULL;
+    }
+    for (int i = 0; i < attributes->actionCount; i++) {
+        const SpawnFileAction * action = &attributes->actions[i];
+        if (action->fd < 0 || action->fd >= PIPE_FD_COUNT ||
+            action->type < PIPE_ENDPOINT_NONE || action->type > PIPE_ENDPOINT_PIPE) {
+            return NULL;
+        }
+    }
+
+    int priority = attributes->priority;
+    if (priority == SPAWN_INHERIT_PRIORITY) {
+        Process * parent = getProcess(parentID);
+        priority = (parent != NULL) ? parent->priority : MID_PRIORITY;
+    }
+    if (priority < MIN_PRIORITY || priority > MAX_PRIORITY) {
+        return NULL;
+    }
+
+    return newProcess(function, argc, argv, priority, parentID, attributes->is_background, attributes->stackSize,
+                      attributes->actions, attributes->actionCount);
+}
+
+int spawnBatch(const SpawnRequest * requests, int count, int parentID, int32_t * pids) {
+    if (requests == NULL || pids == NULL || count < 0 || count > SPAWN_BATCH_MAX) {
+        return -1;
+    }
+
+    int created = 0;
+    for (; created < count; created++) {
+        const SpawnRequest * request = &requests[created];
+        Process * process = spawnProcess(request->function, request->argc, request->argv, parentID, &request->attributes);
+        if (process == NULL) {
+            break;
+        }
+        pids[created] = process->pid;
+    }
+    for (int i = created; i < count; i++) {
+        pids[i] = -1;
+    }
+    return created;
+}
+
 static int initProcessMain(void) {
     while (1) {
         if (init_shell_entry == NULL) {
@@ -344,12 +653,12 @@ static int initProcessMain(void) {
         }
 
         char * shellArgv[] = { "sh", NULL };
-        Process * shell = createProcess(init_shell_entry, 1, shellArgv, MID_PRIORITY, INIT_PROCESS_PID, 0);
+        Process * shell = createProcess(init_shell_entry, 1, shellArgv, MID_PRIORITY, INIT_PROCESS_PID, 0, 0);
         if (shell == NULL) {
             panic("Failed to launch shell process");
         }
 
-        waitPid(shell->pid);
+        waitPid(shell->pid, NULL);
     }
 
     return 0;
@@ -359,23 +668,34 @@ void removeProcess(Process * p){
     if (p == NULL) {
         return;
     }
+    if (p->is_thread) {
+        exitThread(p);
+        return;
+    }
+    terminateThreads(p);
+    waitQueueCancel(p);         // A killed waiter must not swallow a later post
+    pipeCancelLend(p);          // Readers must not copy from the stack or heap about to be freed
+    mutexReleaseAll(p);         // Whoever waits for a mutex the process owned gets it
+    p->child_waiters = NULL;    // Only the process and its threads could be waiting on its children
     releaseForegroundProcess(p);
     p->state = PROCESS_STATE_TERMINATED;
+    processChanged(p);
 
-    semDestroy(p->wait_sem);
-
-    if (PCBTable != NULL && p->pid >= 0 && p->pid < MAX_PROCESSES && PCBTable->processes[p->pid] == p) {
-        PCBTable->processes[p->pid] = NULL;
-        if (PCBTable->processesCount > 0) {
-            PCBTable->processesCount--;
-        }
+    if (PCBTable != NULL && checkValidPid(p->pid)) {
+        pcbTableRemove(p);
     }
 
-    // The children of the terminated process are adopted by the process' parent.
+    // The parent keeps the exit status until it waits for it
     Process * parent = getProcess(p->ppid);
     if (parent != NULL && parent->children != NULL) {
         queueRemove(parent->children, &p->pid);
     }
+    if (parent != NULL && parent->state != PROCESS_STATE_TERMINATED) {
+        recordZombie(parent, p->pid, p->exit_status);
+        wakeChildWaiters(parent, p->pid);
+    }
+
+    // The children of the terminated process are adopted by the process' parent.
     if (parent == NULL || parent->state == PROCESS_STATE_TERMINATED) {
         parent = getProcess(INIT_PROCESS_PID);
     }
@@ -399,29 +719,238 @@ void removeProcess(Process * p){
             }
         }
     }
+
+    // Reclaims every block the process reserved through sys_malloc and never freed
+    myFreeOwnedBy(p->pid);
 	
     freeProcess(p);
 }
 
-void freeProcess(Process * p){
+// argv and the name of a process live at the top of its stack and go away with it
+static void releaseStack(Process * p) {
     if (p->stack_base != NULL) {
-        myFree(p->stack_base);
+        stackCacheRecordUsage(stackHighWater(p), p->stack_size);
+        stackCacheFree(p->stack_base, p->stack_size);
         p->stack_base = NULL;
-    }
-
-    if (p->argv != NULL) {
-        for (int i = 0; i < p->argc; i++) {
-            myFree(p->argv[i]);
+        if (!p->is_thread) {
+            p->argv = NULL;
+            p->name = NULL;
+        } else if (p->thread_leader != NULL) {
+            resourceAdd(p->thread_leader->pid, RESOURCE_STACK, -p->stack_size);
         }
-        myFree(p->argv);
-        p->argv = NULL;
     }
+}
+
+void freeProcess(Process * p){
+    releaseStack(p);
+    freeZombies(p);
     cleanupProcessEndpoints(p);
     queueFree(p->children);
     myFree(p);
 }
 
 
+// ========== Threads ==========
+Process * processGroupLeader(Process * process) {
+    if (process != NULL && process->is_thread && process->thread_leader != NULL) {
+        return process->thread_leader;
+    }
+    return process;
+}
+
+Process * createThread(void * function, void * arg, int stackSize) {
+    Process * current = getCurrentProcess();
+    Process * leader = processGroupLeader(current);
+    if (function == NULL || leader == NULL || leader->is_thread) {
+        return NULL;
+    }
+
+    int pid = getNextPid();
+    if (pid < 0) {
+        return NULL;
+    }
+
+    stackSize = normalizeStackSize(stackSize);
+    if (resourceCharge(leader->pid, RESOURCE_STACK, stackSize) != 0) {
+        return NULL;
+    }
+    uint8_t * stack_base = stackCacheAlloc(stackSize);
+    if (stack_base == NULL) {
+        resourceAdd(leader->pid, RESOURCE_STACK, -stackSize);
+        return NULL;
+    }
+    memset(stack_base, PROCESS_STACK_PAINT, stackSize);
+
+    Process * thread = myMalloc(sizeof(Process));
+    if (thread == NULL && stackCacheFlush() > 0) {
+        thread = myMalloc(sizeof(Process));
+    }
+    if (thread == NULL) {
+        stackCacheFree(stack_base, stackSize);
+        resourceAdd(leader->pid, RESOURCE_STACK, -stackSize);
+        return NULL;
+    }
+
+    // Only the stack and the registers are its own, no argv copies, children queue, semaphore or pipe retains
+    thread->pid = pid;
+    thread->ppid = leader->pid;
+    thread->name = leader->name;
+    thread->priority = leader->priority;
+    thread->state = PROCESS_STATE_READY;
+    thread->argc = 0;
+    thread->argv = NULL;
+    thread->stack_base = stack_base;
+    thread->stack_size = stackSize;
+    thread->rip = function;
+    thread->waiting_for_child = -1;
+    thread->is_background = leader->is_background;
+    thread->is_foreground = 0;
+    thread->children = NULL;
+    thread->exit_status = PROCESS_EXIT_KILLED;
+    thread->zombies = NULL;
+    thread->zombies_tail = NULL;
+    thread->zombie_count = 0;
+    thread->child_waiters = NULL;
+    thread->child_wait_next = NULL;
+    thread->futex_addr = NULL;
+    thread->wait_queue = NULL;
+    thread->wait_next = NULL;
+    thread->wait_prev = NULL;
+    thread->mutexes_held = NULL;
+    thread->pipe_lending = -1;
+    thread->pipe_lend_phase = PIPE_LEND_DONE;
+    thread->stack_untouched = -1;
+    pipeResetEndpoints(thread->fds);
+    thread->ready_next = NULL;
+    thread->ready_prev = NULL;
+    thread->ready_queue = -1;
+    thread->terminated_next = NULL;
+    thread->in_terminated_queue = 0;
+    thread->is_thread = 1;
+    thread->thread_leader = leader;
+    thread->threads = NULL;
+    thread->thread_next = NULL;
+    thread->joiner_pid = -1;
+    resourceInit(&thread->resources, NULL);   // Unused, the thread charges its process
+
+    // The argument goes where a process gets argc, so it arrives as the first parameter
+    thread->rsp = stackInit(stack_base + stackSize - sizeof(uint64_t), function, (uint64_t) arg, NULL);
+    if (thread->rsp == NULL || pcbTableInsert(thread) != 0) {
+        myFree(thread);
+        stackCacheFree(stack_base, stackSize);
+        resourceAdd(leader->pid, RESOURCE_STACK, -stackSize);
+        return NULL;
+    }
+
+    if (addProcessToScheduler(thread) != 0) {
+        pcbTableRemove(thread);
+        myFree(thread);
+        stackCacheFree(stack_base, stackSize);
+        resourceAdd(leader->pid, RESOURCE_STACK, -stackSize);
+        return NULL;
+    }
+
+    thread->thread_next = leader->threads;
+    leader->threads = thread;
+    return thread;
+}
+
+static void unlinkThread(Process * thread) {
+    Process * leader = thread->thread_leader;
+    if (leader == NULL) {
+        return;
+    }
+
+    Process ** link = &leader->threads;
+    while (*link != NULL && *link != thread) {
+        link = &(*link)->thread_next;
+    }
+    if (*link == thread) {
+        *link = thread->thread_next;
+    }
+    thread->thread_next = NULL;
+    thread->thread_leader = NULL;
+}
+
+static void reapThread(Process * thread) {
+    unlinkThread(thread);
+    pcbTableRemove(thread);
+    myFree(thread);
+}
+
+// A finished thread keeps its PID as TERMINATED until it is joined, unless its process is already gone
+static void exitThread(Process * thread) {
+    thread->state = PROCESS_STATE_TERMINATED;
+    processChanged(thread);
+    waitQueueCancel(thread);
+    pipeCancelLend(thread);
+    mutexReleaseAll(thread);
+    releaseStack(thread);
+    stopWaitingForChild(thread, thread->thread_leader);
+
+    if (thread->joiner_pid >= 0) {
+        unblock(thread->joiner_pid);
+        thread->joiner_pid = -1;
+    }
+    if (thread->thread_leader == NULL) {
+        reapThread(thread);
+    }
+}
+
+static int threadExited(Process * thread) {
+    return thread->state == PROCESS_STATE_TERMINATED && !thread->in_terminated_queue;
+}
+
+// Threads end with their process. The running one, if any, is released by the next schedule.
+static void terminateThreads(Process * leader) {
+    Process * thread = leader->threads;
+    leader->threads = NULL;
+
+    while (thread != NULL) {
+        Process * next = thread->thread_next;
+        thread->thread_next = NULL;
+        thread->thread_leader = NULL;
+        thread->name = NULL;
+
+        if (thread->state == PROCESS_STATE_RUNNING) {
+            thread->state = PROCESS_STATE_TERMINATED;
+            enqueueTerminatedProcess(thread);
+        } else if (thread->state == PROCESS_STATE_READY) {
+            removeProcessFromScheduler(thread);
+        }
+
+        if (!thread->in_terminated_queue) {
+            exitThread(thread);
+        }
+        thread = next;
+    }
+}
+
+int joinThread(int tid) {
+    Process * current = getCurrentProcess();
+    Process * thread = getProcess(tid);
+    if (current == NULL || thread == NULL || thread == current || !thread->is_thread ||
+        thread->thread_leader != processGroupLeader(current)) {
+        return -1;
+    }
+
+    while (!threadExited(thread)) {
+        if (thread->joiner_pid >= 0 && thread->joiner_pid != current->pid) {
+            return -1;  // Another thread is already joining it
+        }
+        thread->joiner_pid = current->pid;
+        block(current->pid);
+
+        thread = getProcess(tid);
+        if (thread == NULL || !thread->is_thread) {
+            return -1;
+        }
+    }
+
+    reapThread(thread);
+    return 0;
+}
+
 int getProcessState(Process *process){
     if (process == NULL) {
         return -1;
@@ -437,9 +966,6 @@ int setProcessState(Process *process, int state){
     return 0;
 }
 
-static int checkValidPid(int pid) {
-    return (pid >= 0 && pid < MAX_PROCESSES);
-}
 
 int block(int pid) {
     if (!checkValidPid(pid)) {
@@ -455,11 +981,13 @@ int block(int pid) {
             return -1;
         }
         p->state = PROCESS_STATE_BLOCKED;
+        processChanged(p);
         return 0;
     }
 
     if (p->state == PROCESS_STATE_RUNNING) {
         p->state = PROCESS_STATE_BLOCKED;
+        processChanged(p);
         yield();
         return 0;
     }
@@ -497,6 +1025,7 @@ int kill(int pid) {
 
     // Mark process as terminated
     process->state = PROCESS_STATE_TERMINATED;
+    processChanged(process);
     if (previousState == PROCESS_STATE_RUNNING) {
         enqueueTerminatedProcess(process);
         // interrupt the current process to switch context
@@ -505,6 +1034,12 @@ int kill(int pid) {
     }
 
     removeProcess(process);
+
+    // A thread that killed its own process ends with it
+    Process * current = getCurrentProcess();
+    if (current != NULL && current->state == PROCESS_STATE_TERMINATED) {
+        yield();
+    }
     return 0;
 }
 
@@ -518,6 +1053,7 @@ int unblock(int pid) {
         return -1;
     }
     process->state = PROCESS_STATE_READY;
+    processChanged(process);
     addProcessToScheduler(process);
     return 0;
 }
@@ -549,118 +1085,114 @@ int nice(int pid, int newPriority) {
             return -1;
         }
     }
+    processChanged(process);
 
     return 0;
 }
 
-int waitPid(int pid) {
-    Process * p = getProcess(pid);
-    if (p == NULL) {
-        return -1; // Child process doesn't exist
-    }
-
+// Children report to the process, so a thread waits on the children of its process
+static int waitForChild(int pid, int *status) {
     Process * current = getCurrentProcess();
-    if (current == NULL) {
+    Process * parent = processGroupLeader(current);
+    if (current == NULL || parent == NULL) {
         return -1;
     }
 
-    // Child is already terminated
-    if (p->state == PROCESS_STATE_TERMINATED) {
-        if (current->children != NULL) {
-            queueRemove(current->children, &pid);
+    while (1) {
+        int found = takeZombie(parent, pid, status);
+        if (found >= 0) {
+            return found;
         }
-        return 0;
-    }
-    if(p->wait_sem == NULL) {
-        return -1;
-    }
-    int waitResult = wait(p->wait_sem);
-    if (current->children != NULL) {
-        queueRemove(current->children, &pid);
-    }
-    return waitResult;
-}
 
-int waitChildren(void) {
-    Process * current = getCurrentProcess();
-    if (current == NULL) {
-        return -1;
-    }
-
-    if (current->children == NULL || queueIsEmpty(current->children)) {
-        return 0;
-    }
+        int pending = (pid == WAIT_ANY_CHILD) ? !queueIsEmpty(parent->children)
+                                              : queueElementExists(parent->children, &pid);
+        if (!pending) {
+            return -1;
+        }
 
-    int childCount = queueSize(current->children);
-    if (childCount <= 0) {
-        return 0;
+        current->waiting_for_child = pid;
+        current->child_wait_next = parent->child_waiters;
+        parent->child_waiters = current;
+        block(current->pid);
+        stopWaitingForChild(current, parent);   // In case it was woken by something else
     }
+}
 
-    if (childCount > MAX_PROCESSES) {
-        childCount = MAX_PROCESSES;
+int waitPid(int pid, int * status) {
+    if (!checkValidPid(pid)) {
+        return -1;
     }
+    return (waitForChild(pid, status) == pid) ? 0 : -1;
+}
 
-    int childPids[MAX_PROCESSES];
-
-    if (queueBeginCyclicIter(current->children) == NULL) {
-        return 0;
-    }
+int waitAny(int * status) {
+    return waitForChild(WAIT_ANY_CHILD, status);
+}
 
-    for (int i = 0; i < childCount; i++) {
-        queueNextCyclicIter(current->children, &childPids[i]);
+// Children are collected in the order they finish, not in PID order
+int waitChildren(void) {
+    while (waitAny(NULL) >= 0) {
+        ;
     }
+    return 0;
+}
 
-    int result = 0;
-
-    for (int i = 0; i < childCount; i++) {
-        int pid = childPids[i];
-        Process * child = getProcess(pid);
-        if (child == NULL) {
-            queueRemove(current->children, &pid);
-            continue;
-        }
-
-        if (child->state == PROCESS_STATE_TERMINATED) {
-            queueRemove(current->children, &pid);
-            continue;
-        }
-
-        if (child->wait_sem == NULL) {
-            queueRemove(current->children, &pid);
-            result = -1;
-            continue;
-        }
-
-        if (wait(child->wait_sem) != 0) {
-            result = -1;
-        }
-
-        queueRemove(current->children, &pid);
+void exitCurrentProcess(int status) {
+    Process * current = getCurrentProcess();
+    if (current == NULL) {
+        return;
     }
-
-    return result;
+    current->exit_status = status;
+    kill(current->pid);
 }
 
 Process * getProcess(int pid) {
 	if (PCBTable == NULL || !checkValidPid(pid)) {
 		return NULL;
 	}
-	return PCBTable->processes[pid];
+	pid_leaf *leaf = PCBTable->leaves[pid >> PID_LEAF_BITS];
+	return (leaf == NULL) ? NULL : leaf->processes[pid & (PID_LEAF_SIZE - 1)];
 }
 
 
-int getProcessInfo(int pid, ProcessInformation * info){
-    if(info == NULL || !checkValidPid(pid)){
-        return -1;
+// Bytes of the stack that were ever written. The first call scans the paint up from the base. Later calls
+// start from the mark the previous one left and walk down only until STACK_SCAN_GAP bytes in a row are
+// still paint, so a scan costs about what the stack grew since and can run with interrupts off.
+int stackHighWater(Process * process) {
+    if (process == NULL || process->stack_base == NULL) {
+        return 0;
     }
-
-    _cli();
-    Process * process = getProcess(pid);
-    if(process == NULL){
-        _sti();
-        return -1;
+    const uint64_t paintWord = 0x0101010101010101ULL * PROCESS_STACK_PAINT;
+    int untouched;
+    if (process->stack_untouched < 0) {
+        untouched = 0;
+        // A word at a time while it is all paint, then the bytes of the first word that is not
+        while (untouched + (int)sizeof(uint64_t) <= process->stack_size
+               && *(uint64_t *)(process->stack_base + untouched) == paintWord) {
+            untouched += sizeof(uint64_t);
+        }
+    } else {
+        untouched = process->stack_untouched;
+        int word = untouched & ~(int)(sizeof(uint64_t) - 1);
+        int paintRun = 0;
+        while (word >= (int)sizeof(uint64_t) && paintRun < STACK_SCAN_GAP) {
+            word -= sizeof(uint64_t);
+            if (*(uint64_t *)(process->stack_base + word) == paintWord) {
+                paintRun += sizeof(uint64_t);
+            } else {
+                untouched = word;
+                paintRun = 0;
+            }
+        }
+    }
+    while (untouched < process->stack_size && process->stack_base[untouched] == PROCESS_STACK_PAINT) {
+        untouched++;
     }
+    process->stack_untouched = untouched;
+    return process->stack_size - untouched;
+}
 
+static void fillProcessInfo(Process * process, ProcessInformation * info) {
     info->pid = process->pid;
 
     if (process->name != NULL) {
@@ -675,7 +1207,25 @@ int getProcessInfo(int pid, ProcessInformation * info){
     info->rsp = process->rsp;
     info->stack_base = process->stack_base;
     info->is_foreground = process->is_foreground;
-    _sti();
+    info->stack_size = process->stack_size;
+    info->stack_used = stackHighWater(process);
+    info->resources = processGroupLeader(process)->resources;
+}
+
+// Scans the stack of the process an entry describes, with interrupts off only for that one stack
+int getProcessInfo(int pid, ProcessInformation * info){
+    if(info == NULL || !checkValidPid(pid)){
+        return -1;
+    }
+
+    uint64_t flags = _cli_save();
+    Process * process = getProcess(pid);
+    if(process == NULL){
+        _restore_interrupts(flags);
+        return -1;
+    }
+    fillProcessInfo(process, info);
+    _restore_interrupts(flags);
     return 0;
 }
 
@@ -684,13 +1234,9 @@ Process * getForegroundProcess(void) {
         return NULL;
     }
 
-    _cli();
-    int pid = PCBTable->foreground_pid;
-    Process *process = NULL;
-    if (pid >= 0 && pid < MAX_PROCESSES) {
-        process = PCBTable->processes[pid];
-    }
-    _sti();
+    uint64_t flags = _cli_save();
+    Process *process = getProcess(PCBTable->foreground_pid);
+    _restore_interrupts(flags);
     return process;
 }
 
@@ -699,22 +1245,21 @@ void setForegroundProcess(Process * process) {
         return;
     }
 
-    _cli();
-    int currentPid = PCBTable->foreground_pid;
-    if (currentPid >= 0 && currentPid < MAX_PROCESSES) {
-        Process *current = PCBTable->processes[currentPid];
-        if (current != NULL) {
-            current->is_foreground = 0;
-        }
+    uint64_t flags = _cli_save();
+    Process *current = getProcess(PCBTable->foreground_pid);
+    if (current != NULL) {
+        current->is_foreground = 0;
+        processChanged(current);
     }
 
     if (process != NULL) {
         PCBTable->foreground_pid = process->pid;
         process->is_foreground = 1;
+        processChanged(process);
     } else {
         PCBTable->foreground_pid = -1;
     }
-    _sti();
+    _restore_interrupts(flags);
 }
 
 void releaseForegroundProcess(Process * process) {
@@ -757,17 +1302,68 @@ int killForegroundProcess(void) {
     return kill(foreground->pid);
 }
 
-int ps(ProcessInformation * processInfoTable){
+int ps(ProcessInformation * processInfoTable, int maxCount){
+    if (PCBTable == NULL) {
+        return -1;
+    }
     if(processInfoTable == NULL){
+        return PCBTable->processesCount;
+    }
+
+    ProcessSnapshot snapshot;
+    return processSnapshot(0, processInfoTable, maxCount, &snapshot);
+}
+
+// Removals after since, -1 when the ring no longer reaches back that far
+static int removedSince(uint64_t since, ProcessSnapshot * snapshot) {
+    if (since < PCBTable->removed_floor) {
+        return -1;
+    }
+    int count = 0;
+    for (int i = 0; i < REMOVED_HISTORY; i++) {
+        int slot = (PCBTable->removed_next + i) % REMOVED_HISTORY;
+        if (PCBTable->removed_generations[slot] > since) {
+            snapshot->removed[count++] = PCBTable->removed_pids[slot];
+        }
+    }
+    return count;
+}
+
+int processSnapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot) {
+    if (PCBTable == NULL || table == NULL || snapshot == NULL || maxCount < 0) {
         return -1;
     }
 
+    // A single pass with interrupts off, so every entry is from the same instant. Stack scans resume from
+    // each process's last mark, so they stay short enough to be part of it.
+    uint64_t flags = _cli_save();
+    snapshot->generation = PCBTable->generation;
+    snapshot->total = PCBTable->processesCount;
+    snapshot->removedCount = 0;
+    snapshot->full = 1;
+    if (since != 0 && since <= PCBTable->generation) {
+        int removed = removedSince(since, snapshot);
+        if (removed >= 0) {
+            snapshot->full = 0;
+            snapshot->removedCount = removed;
+        }
+    }
+
+    // Only visits taken PIDs, walking the used bitmap one set bit at a time
     int count = 0;
-    for(int pid = 0; pid < MAX_PROCESSES; pid++){
-        if(getProcessInfo(pid, &processInfoTable[count]) == 0){
-            count++;
+    for (int word = 0; word < PID_WORDS && count < maxCount; word++) {
+        uint64_t pids = PCBTable->used_pids[word];
+        while (pids != 0 && count < maxCount) {
+            int pid = word * 64 + __builtin_ctzll(pids);
+            pids &= pids - 1;
+            Process * process = getProcess(pid);
+            if (process != NULL && (snapshot->full || process->changed_generation > since)) {
+                fillProcessInfo(process, &table[count++]);
+            }
         }
     }
+    snapshot->count = count;
+    _restore_interrupts(flags);
     return count;
 }
 
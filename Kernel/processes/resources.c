@@ -0,0 +1,114 @@
+#include "resources.h"
+#include "process.h"
+#include "memory.h"
+#include "stackCache.h"
+#include "interrupts.h"
+
+static Process * chargedProcess(int pid) {
+    return processGroupLeader(getProcess(pid));
+}
+
+// Heap and stacks may not eat into the shell's reserve unless the shell or the processes below it ask for them
+static int reserveAllows(Process * requester, int amount) {
+    if (requester->pid <= SHELL_PROCESS_PID) {
+        return 1;
+    }
+    int available = 0;
+    memstats(NULL, NULL, &available);
+    // Cached stacks go back to the heap as soon as an allocation needs them
+    return available + stackCacheBytes() - amount >= SHELL_HEAP_RESERVE;
+}
+
+static int processAllows(Process * process, ResourceType type, int amount) {
+    int limit = process->resources.limits[type];
+    if (limit != RESOURCE_UNLIMITED && process->resources.usage[type] + amount > limit) {
+        return 0;
+    }
+    if ((type == RESOURCE_HEAP || type == RESOURCE_STACK) && !reserveAllows(process, amount)) {
+        return 0;
+    }
+    return 1;
+}
+
+void resourceInit(ResourceUsage * resources, const ResourceUsage * parent) {
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        resources->usage[i] = 0;
+        resources->limits[i] = (parent == NULL) ? RESOURCE_UNLIMITED : parent->limits[i];
+    }
+}
+
+int resourceCheck(int pid, ResourceType type, int amount) {
+    if (type < 0 || type >= RESOURCE_COUNT) {
+        return -1;
+    }
+    Process * process = chargedProcess(pid);
+    if (process == NULL || amount <= 0) {
+        return 0;
+    }
+    return processAllows(process, type, amount) ? 0 : -1;
+}
+
+void resourceAdd(int pid, ResourceType type, int delta) {
+    if (type < 0 || type >= RESOURCE_COUNT) {
+        return;
+    }
+    Process * process = chargedProcess(pid);
+    if (process == NULL) {
+        return;
+    }
+    int usage = process->resources.usage[type] + delta;
+    process->resources.usage[type] = (usage < 0) ? 0 : usage;
+}
+
+int resourceCharge(int pid, ResourceType type, int amount) {
+    if (resourceCheck(pid, type, amount) != 0) {
+        return -1;
+    }
+    resourceAdd(pid, type, amount);
+    return 0;
+}
+
+int resourceCheckChild(int parentPid, int stackSize) {
+    Process * parent = chargedProcess(parentPid);
+    if (parent == NULL) {
+        return 0;
+    }
+    // The child inherits the limit, its own stack is the first thing charged against it
+    int limit = parent->resources.limits[RESOURCE_STACK];
+    if (limit != RESOURCE_UNLIMITED && stackSize > limit) {
+        return -1;
+    }
+    return reserveAllows(parent, stackSize) ? 0 : -1;
+}
+
+int setResourceLimit(int pid, ResourceType type, int limit) {
+    if (type < 0 || type >= RESOURCE_COUNT || limit < RESOURCE_UNLIMITED) {
+        return -1;
+    }
+    uint64_t flags = _cli_save();
+    Process * process = chargedProcess(pid);
+    if (process == NULL) {
+        _restore_interrupts(flags);
+        return -1;
+    }
+    // A limit below the current usage only makes the next charges fail
+    process->resources.limits[type] = limit;
+    processChanged(process);
+    _restore_interrupts(flags);
+    return 0;
+}
+
+int getResourceUsage(int pid, ResourceUsage * resources) {
+    if (resources == NULL) {
+        return -1;
+    }
+    uint64_t flags = _cli_save();
+    Process * process = chargedProcess(pid);
+    if (process == NULL) {
+        _restore_interrupts(flags);
+        return -1;
+    }
+    *resources = process->resources;
+    _restore_interrupts(flags);
+    return 0;
+}
@@ -17,12 +17,18 @@ static void ageWaitingPriorities(void);
 static Process *tryDequeueAtPriority(int priority);
 static int readyQueuesAreEmpty(void);
 
+// Ready queues are intrusive lists threaded through the PCBs, so they never fill up
 typedef struct {
-    Process *entries[MAX_PROCESSES];
+    Process *head;
+    Process *tail;
     int count;
+    int priority;
 } ReadyQueue;
 
-static void readyQueueInit(ReadyQueue *queue) {
+static void readyQueueInit(ReadyQueue *queue, int priority) {
+    queue->priority = priority;
+    queue->head = NULL;
+    queue->tail = NULL;
     queue->count = 0;
 }
 
@@ -31,39 +37,50 @@ static int readyQueueIsEmpty(ReadyQueue *queue) {
 }
 
 static int readyQueueEnqueue(ReadyQueue *queue, Process *process) {
-    if (queue->count >= MAX_PROCESSES) {
-        return -1;
+    if (process->ready_queue >= 0) {
+        return 0;
+    }
+    process->ready_next = NULL;
+    process->ready_prev = queue->tail;
+    if (queue->tail != NULL) {
+        queue->tail->ready_next = process;
+    } else {
+        queue->head = process;
     }
-    queue->entries[queue->count++] = process;
+    queue->tail = process;
+    process->ready_queue = (int8_t)queue->priority;
+    queue->count++;
     return 0;
 }
 
-static Process *readyQueueDequeue(ReadyQueue *queue) {
-    if (readyQueueIsEmpty(queue)) {
-        return NULL;
+static int readyQueueRemove(ReadyQueue *queue, Process *process) {
+    if (process == NULL || process->ready_queue != queue->priority) {
+        return -1;
+    }
+
+    if (process->ready_prev != NULL) {
+        process->ready_prev->ready_next = process->ready_next;
+    } else {
+        queue->head = process->ready_next;
     }
-    Process *next = queue->entries[0];
-    for (int i = 1; i < queue->count; i++) {
-        queue->entries[i - 1] = queue->entries[i];
+    if (process->ready_next != NULL) {
+        process->ready_next->ready_prev = process->ready_prev;
+    } else {
+        queue->tail = process->ready_prev;
     }
+    process->ready_next = NULL;
+    process->ready_prev = NULL;
+    process->ready_queue = -1;
     queue->count--;
-    return next;
+    return 0;
 }
 
-static int readyQueueRemove(ReadyQueue *queue, Process *process) {
-    if (readyQueueIsEmpty(queue) || process == NULL) {
-        return -1;
-    }
-    for (int i = 0; i < queue->count; i++) {
-        if (queue->entries[i] == process) {
-            for (int j = i + 1; j < queue->count; j++) {
-                queue->entries[j - 1] = queue->entries[j];
-            }
-            queue->count--;
-            return 0;
-        }
+static Process *readyQueueDequeue(ReadyQueue *queue) {
+    Process *next = queue->head;
+    if (next != NULL) {
+        readyQueueRemove(queue, next);
     }
-    return -1;
+    return next;
 }
 
 typedef struct scheduler {
@@ -102,7 +119,7 @@ int initScheduler() {
     }
 
     for (int priority = MIN_PRIORITY; priority <= MAX_PRIORITY; priority++) {
-        readyQueueInit(&scheduler->readyQueues[priority]);
+        readyQueueInit(&scheduler->readyQueues[priority], priority);
     }
 
     scheduler->currentQuantum = 0;
@@ -114,7 +131,7 @@ int initScheduler() {
     char ** idleArgv = myMalloc(sizeof(char *) * 2);
     idleArgv[0] = "idle";
     idleArgv[1] = NULL;
-    Process *idleProcess = createProcess((void *)idleTask, 1, idleArgv, MIN_PRIORITY, -1, 1);
+    Process *idleProcess = createProcess((void *)idleTask, 1, idleArgv, MIN_PRIORITY, -1, 1, 0);
     if (idleProcess == NULL) {
         panic("Failed to create idle process.");
     }
@@ -160,6 +177,7 @@ uint8_t *schedule(uint8_t *rsp) {
             if (scheduler->currentProcess->state == PROCESS_STATE_RUNNING) {
                 // Move the current process out of RUNNING state before picking the next one.
                 Process *toRequeue = scheduler->currentProcess;
+                // Going between READY and RUNNING happens every tick, snapshots do not report it as a change
                 toRequeue->state = PROCESS_STATE_READY;
                 if (toRequeue != scheduler->idleProcess) {
                     enqueueReadyProcess(toRequeue);
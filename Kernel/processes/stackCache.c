@@ -0,0 +1,144 @@
+#include "stackCache.h"
+#include "process.h"
+#include "memory.h"
+#include <stddef.h>
+
+// Released stacks form a LIFO per size, linked through their first bytes, so the
+// next process gets the stack that was touched last and is most likely still in cache.
+typedef struct CachedStack {
+    struct CachedStack * next;
+} CachedStack;
+
+typedef struct StackClass {
+    CachedStack * top;
+    int count;
+} StackClass;
+
+static StackClass classes[STACK_CACHE_CLASSES];
+static int highWaterMark = STACK_CACHE_HIGH_WATER;
+static uint32_t hits = 0;
+static uint32_t misses = 0;
+static uint32_t released = 0;
+static uint32_t peakUsage = 0;
+static uint32_t exhausted = 0;
+
+// Index of the class for the given size, -1 when the size is not cached
+static int classForSize(int size) {
+    int classSize = STACK_CACHE_MIN_SIZE;
+    for (int i = 0; i < STACK_CACHE_CLASSES; i++, classSize <<= 1) {
+        if (size == classSize) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void trimClass(StackClass * stackClass, int limit) {
+    while (stackClass->count > limit) {
+        CachedStack * stack = stackClass->top;
+        stackClass->top = stack->next;
+        stackClass->count--;
+        myFree(stack);
+        released++;
+    }
+}
+
+void stackCacheInit(void) {
+    for (int i = 0; i < STACK_CACHE_CLASSES; i++) {
+        classes[i].top = NULL;
+        classes[i].count = 0;
+    }
+    highWaterMark = STACK_CACHE_HIGH_WATER;
+    hits = 0;
+    misses = 0;
+    released = 0;
+    peakUsage = 0;
+    exhausted = 0;
+
+    for (int i = 0; i < STACK_CACHE_PREFILL && i < highWaterMark; i++) {
+        void * stack = myMalloc(PROCESS_STACK_SIZE);
+        if (stack == NULL) {
+            break;
+        }
+        stackCacheFree(stack, PROCESS_STACK_SIZE);
+    }
+}
+
+void * stackCacheAlloc(int size) {
+    int index = classForSize(size);
+    if (index >= 0 && classes[index].top != NULL) {
+        CachedStack * stack = classes[index].top;
+        classes[index].top = stack->next;
+        classes[index].count--;
+        hits++;
+        return stack;
+    }
+
+    misses++;
+    void * stack = myMalloc(size);
+    if (stack == NULL && stackCacheFlush() > 0) {
+        stack = myMalloc(size);
+    }
+    return stack;
+}
+
+void stackCacheFree(void * stack, int size) {
+    if (stack == NULL) {
+        return;
+    }
+
+    int index = classForSize(size);
+    if (index < 0 || classes[index].count >= highWaterMark) {
+        myFree(stack);
+        released++;
+        return;
+    }
+
+    CachedStack * cached = (CachedStack *) stack;
+    cached->next = classes[index].top;
+    classes[index].top = cached;
+    classes[index].count++;
+}
+
+int stackCacheFlush(void) {
+    int bytes = stackCacheBytes();
+    for (int i = 0; i < STACK_CACHE_CLASSES; i++) {
+        trimClass(&classes[i], 0);
+    }
+    return bytes;
+}
+
+int stackCacheBytes(void) {
+    int bytes = 0;
+    int classSize = STACK_CACHE_MIN_SIZE;
+    for (int i = 0; i < STACK_CACHE_CLASSES; i++, classSize <<= 1) {
+        bytes += classes[i].count * classSize;
+    }
+    return bytes;
+}
+
+void stackCacheRecordUsage(int used, int size) {
+    if ((uint32_t) used > peakUsage) {
+        peakUsage = (uint32_t) used;
+    }
+    if (used >= size) {
+        exhausted++;
+    }
+}
+
+void stackCacheGetStats(StackCacheStats * stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->hits = hits;
+    stats->misses = misses;
+    stats->released = released;
+    stats->cached = 0;
+    for (int i = 0; i < STACK_CACHE_CLASSES; i++) {
+        stats->cached += (uint32_t) classes[i].count;
+    }
+    stats->highWater = (uint32_t) highWaterMark;
+    stats->peakUsage = peakUsage;
+    stats->exhausted = exhausted;
+}
@@ -0,0 +1,118 @@
+#include "barrier.h"
+#include "waitQueue.h"
+#include "memory.h"
+#include "process.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+// Relies on running with interrupts off like mutex.c. The waiters of the current round are exactly the
+// barrier's queue, so a process killed while waiting stops counting as arrived when it leaves the queue.
+// A released waiter only checks that it left the queue and never touches the object again, since the
+// process that released it may already have destroyed it.
+
+struct barrierCDT {
+    int parties;
+    WaitQueue waiters;
+    int creatorPid;
+};
+
+struct latchCDT {
+    int count;
+    WaitQueue waiters;
+    int creatorPid;
+};
+
+barrierADT barrierCreate(int parties, int creatorPid) {
+    if (parties <= 0 || resourceCheck(creatorPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        return NULL;
+    }
+    barrierADT barrier = myMalloc(sizeof(struct barrierCDT));
+    if (barrier == NULL) {
+        return NULL;
+    }
+    barrier->parties = parties;
+    waitQueueInit(&barrier->waiters);
+    barrier->creatorPid = creatorPid;
+    resourceAdd(creatorPid, RESOURCE_SEMAPHORES, 1);
+    return barrier;
+}
+
+int barrierWait(barrierADT barrier) {
+    Process * current = getCurrentProcess();
+    if (barrier == NULL || current == NULL) {
+        return -1;
+    }
+
+    if (barrier->waiters.count + 1 == barrier->parties) {
+        waitQueueWakeAll(&barrier->waiters);
+        return 1;
+    }
+
+    waitQueueAppend(&barrier->waiters, current);
+    do {
+        block(current->pid);
+    } while (current->wait_queue == &barrier->waiters);
+    return 0;
+}
+
+int barrierDestroy(barrierADT barrier) {
+    if (barrier == NULL || barrier->waiters.count > 0) {
+        return -1;
+    }
+    resourceAdd(barrier->creatorPid, RESOURCE_SEMAPHORES, -1);
+    myFree(barrier);
+    return 0;
+}
+
+latchADT latchCreate(int count, int creatorPid) {
+    if (count < 0 || resourceCheck(creatorPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        return NULL;
+    }
+    latchADT latch = myMalloc(sizeof(struct latchCDT));
+    if (latch == NULL) {
+        return NULL;
+    }
+    latch->count = count;
+    waitQueueInit(&latch->waiters);
+    latch->creatorPid = creatorPid;
+    resourceAdd(creatorPid, RESOURCE_SEMAPHORES, 1);
+    return latch;
+}
+
+int latchCountDown(latchADT latch, int count) {
+    if (latch == NULL || count < 0) {
+        return -1;
+    }
+    if (latch->count == 0) {
+        return 0;
+    }
+    latch->count = (count >= latch->count) ? 0 : latch->count - count;
+    if (latch->count == 0) {
+        waitQueueWakeAll(&latch->waiters);
+    }
+    return latch->count;
+}
+
+int latchWait(latchADT latch) {
+    Process * current = getCurrentProcess();
+    if (latch == NULL || current == NULL) {
+        return -1;
+    }
+    if (latch->count == 0) {
+        return 0;
+    }
+    waitQueueAppend(&latch->waiters, current);
+    do {
+        block(current->pid);
+    } while (current->wait_queue == &latch->waiters);
+    return 0;
+}
+
+int latchDestroy(latchADT latch) {
+    if (latch == NULL || latch->waiters.count > 0) {
+        return -1;
+    }
+    resourceAdd(latch->creatorPid, RESOURCE_SEMAPHORES, -1);
+    myFree(latch);
+    return 0;
+}
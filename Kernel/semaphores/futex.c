@@ -0,0 +1,55 @@
+#include "futex.h"
+#include "process.h"
+#include "scheduler.h"
+#include "waitQueue.h"
+#include <stddef.h>
+
+// Waiters hash by address into buckets, each a FIFO wait queue shared by every address that lands in it
+#define FUTEX_BUCKETS 64
+
+static WaitQueue buckets[FUTEX_BUCKETS];
+
+static WaitQueue * bucketOf(int32_t * addr) {
+    return &buckets[((uintptr_t)addr >> 2) % FUTEX_BUCKETS];
+}
+
+int futexWait(int32_t * addr, int32_t expected) {
+    Process * current = getCurrentProcess();
+    if (addr == NULL || ((uintptr_t)addr & (sizeof(int32_t) - 1)) != 0 || current == NULL) {
+        return -1;
+    }
+    if (*addr != expected) {
+        return 1;
+    }
+
+    WaitQueue * bucket = bucketOf(addr);
+    current->futex_addr = addr;
+    waitQueueAppend(bucket, current);
+
+    // futexWake takes the PCB out of the bucket, a stray unblock (the block command) leaves it there
+    do {
+        block(current->pid);
+    } while (current->wait_queue == bucket);
+    current->futex_addr = NULL;
+    return 0;
+}
+
+int futexWake(int32_t * addr, int count) {
+    if (addr == NULL || count <= 0) {
+        return 0;
+    }
+
+    WaitQueue * bucket = bucketOf(addr);
+    Process * process = bucket->head;
+    int woken = 0;
+    while (process != NULL && woken < count) {
+        Process * next = process->wait_next;
+        if (process->futex_addr == addr) {
+            waitQueueUnlink(bucket, process);
+            unblock(process->pid);
+            woken++;
+        }
+        process = next;
+    }
+    return woken;
+}
@@ -0,0 +1,189 @@
+#include "lockStats.h"
+#include <stddef.h>
+
+#ifndef LOCK_STATS
+
+int lockStatsSnapshot(LockStatsEntry * table, int maxCount) {
+    return -1;
+}
+
+#else
+
+#include "semaphores.h"
+#include "scheduler.h"
+#include "process.h"
+#include "lib.h"
+
+// Open-addressing table keyed by address. Freed objects keep their entry with address 0, so their numbers
+// survive until the slot is needed by a new object. Counters are best effort when an interrupt lands in
+// the middle of an update.
+typedef struct {
+    LockStatsEntry entry;
+    uint8_t used;
+} LockStatsSlot;
+
+static LockStatsSlot slots[LOCK_STATS_MAX];
+
+static int currentPid(void) {
+    Process * current = getCurrentProcess();
+    return current == NULL ? -1 : current->pid;
+}
+
+static void copyName(char * destination, const char * name) {
+    int i = 0;
+    for (; name != NULL && name[i] != '\0' && i < LOCK_STATS_NAME_LENGTH - 1; i++) {
+        destination[i] = name[i];
+    }
+    destination[i] = '\0';
+}
+
+// Entry of the object, created on first use. NULL when every slot holds a live object.
+static LockStatsEntry * entryOf(const void * object, LockKind kind) {
+    uint64_t address = (uint64_t)object;
+    int start = (int)((address >> 3) % LOCK_STATS_MAX);
+    int reusable = -1;
+
+    for (int probes = 0; probes < LOCK_STATS_MAX; probes++) {
+        int index = (start + probes) % LOCK_STATS_MAX;
+        LockStatsSlot * slot = &slots[index];
+        if (!slot->used) {
+            if (reusable < 0) {
+                reusable = index;
+            }
+            break;
+        }
+        if (slot->entry.address == address) {
+            return &slot->entry;
+        }
+        if (slot->entry.address == 0 && reusable < 0) {
+            reusable = index;
+        }
+    }
+    if (reusable < 0) {
+        return NULL;
+    }
+
+    LockStatsSlot * slot = &slots[reusable];
+    slot->used = 1;
+    slot->entry = (LockStatsEntry){0};
+    slot->entry.address = address;
+    slot->entry.kind = kind;
+    slot->entry.holderPid = -1;
+    return &slot->entry;
+}
+
+static void recordCycles(LockStatsEntry * entry, uint64_t cycles) {
+    entry->waitCycles += cycles;
+    if (cycles > entry->maxWaitCycles) {
+        entry->maxWaitCycles = cycles;
+    }
+}
+
+static void recordWait(LockStatsEntry * entry, uint64_t cycles, int contended) {
+    entry->acquisitions++;
+    entry->contended += contended ? 1 : 0;
+    recordCycles(entry, cycles);
+    entry->holderPid = currentPid();
+}
+
+void lockStatsName(const void * object, LockKind kind, const char * name) {
+    LockStatsEntry * entry = entryOf(object, kind);
+    if (entry != NULL) {
+        copyName(entry->name, name);
+    }
+}
+
+void lockStatsForget(const void * object) {
+    for (int i = 0; i < LOCK_STATS_MAX; i++) {
+        if (slots[i].used && slots[i].entry.address == (uint64_t)object) {
+            slots[i].entry.address = 0;
+            slots[i].entry.holderPid = -1;
+            return;
+        }
+    }
+}
+
+void lockStatsSpinLock(uint8_t * lock) {
+    uint64_t start = _rdtsc();
+    uint64_t spins = 0;
+    while (semTryLock(lock) != 0) {
+        spins++;
+    }
+    LockStatsEntry * entry = entryOf(lock, LOCK_KIND_SPINLOCK);
+    if (entry != NULL) {
+        entry->spins += spins;
+        recordWait(entry, _rdtsc() - start, spins > 0);
+    }
+}
+
+void lockStatsSpinUnlock(uint8_t * lock) {
+    LockStatsEntry * entry = entryOf(lock, LOCK_KIND_SPINLOCK);
+    if (entry != NULL) {
+        entry->holderPid = -1;
+    }
+    (semUnlock)(lock);
+}
+
+LockStatsEntry * lockStatsSemWaiting(const void * sem, const char * name, int blocked) {
+    LockStatsEntry * entry = entryOf(sem, LOCK_KIND_SEMAPHORE);
+    if (entry == NULL) {
+        return NULL;
+    }
+    if (entry->name[0] == '\0' && name != NULL) {
+        copyName(entry->name, name);
+    }
+    entry->acquisitions++;
+    entry->contended += blocked ? 1 : 0;
+    return entry;
+}
+
+// Only compares addresses, sem may already be freed. A forgotten entry (address 0) still belongs to it.
+void lockStatsSemWaited(LockStatsEntry * entry, const void * sem, uint64_t startCycles) {
+    if (entry == NULL || (entry->address != (uint64_t)sem && entry->address != 0)) {
+        return;
+    }
+    recordCycles(entry, _rdtsc() - startCycles);
+    if (entry->address != 0) {
+        entry->holderPid = currentPid();
+    }
+}
+
+// A post by the process that last got through releases it, any other post leaves the holder alone
+void lockStatsSemPosted(const void * sem) {
+    LockStatsEntry * entry = entryOf(sem, LOCK_KIND_SEMAPHORE);
+    if (entry != NULL && entry->holderPid == currentPid()) {
+        entry->holderPid = -1;
+    }
+}
+
+int lockStatsSnapshot(LockStatsEntry * table, int maxCount) {
+    if (table == NULL || maxCount <= 0) {
+        return 0;
+    }
+
+    // Insertion sort into the caller's table, keeping only the maxCount longest waits
+    int count = 0;
+    for (int i = 0; i < LOCK_STATS_MAX; i++) {
+        if (!slots[i].used || slots[i].entry.acquisitions == 0) {
+            continue;
+        }
+        LockStatsEntry * entry = &slots[i].entry;
+        int position = count;
+        while (position > 0 && table[position - 1].waitCycles < entry->waitCycles) {
+            position--;
+        }
+        if (position >= maxCount) {
+            continue;
+        }
+        for (int j = (count < maxCount ? count : maxCount - 1); j > position; j--) {
+            table[j] = table[j - 1];
+        }
+        table[position] = *entry;
+        if (count < maxCount) {
+            count++;
+        }
+    }
+    return count;
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "mutex.h"
+#include "waitQueue.h"
+#include "memory.h"
+#include "process.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+// Like futexes, mutexes and conditions rely on running with interrupts off, as every syscall does, so
+// they need no spinlock of their own
+
+struct mutexCDT {
+    Process * owner;            // NULL while unlocked
+    int depth;                  // Locks the owner holds, only a recursive mutex goes above 1
+    uint8_t recursive;
+    WaitQueue waiters;
+    struct mutexCDT * held_next; // Next mutex owned by the same process
+    int creatorPid;             // Process charged for the mutex until it is destroyed
+};
+
+struct condCDT {
+    WaitQueue waiters;
+    mutexADT mutex;             // Mutex the current waiters released, NULL while nobody waits
+    int creatorPid;
+};
+
+static void heldPush(Process * process, mutexADT mutex) {
+    mutex->held_next = process->mutexes_held;
+    process->mutexes_held = mutex;
+}
+
+static void heldRemove(Process * process, mutexADT mutex) {
+    mutexADT * link = &process->mutexes_held;
+    while (*link != NULL && *link != mutex) {
+        link = &(*link)->held_next;
+    }
+    if (*link == mutex) {
+        *link = mutex->held_next;
+    }
+    mutex->held_next = NULL;
+}
+
+static void grant(mutexADT mutex, Process * process) {
+    mutex->owner = process;
+    mutex->depth = 1;
+    heldPush(process, mutex);
+}
+
+// Ownership passes straight to the oldest waiter, so it cannot be taken by someone who never waited
+static void release(mutexADT mutex) {
+    heldRemove(mutex->owner, mutex);
+    Process * next = waitQueuePop(&mutex->waiters);
+    if (next == NULL) {
+        mutex->owner = NULL;
+        mutex->depth = 0;
+        return;
+    }
+    grant(mutex, next);
+    unblock(next->pid);
+}
+
+// Blocks until a release hands the mutex over. A stray unblock finds it still owned by someone else and sleeps again.
+static void sleepUntilOwner(mutexADT mutex, Process * current) {
+    do {
+        block(current->pid);
+    } while (mutex->owner != current);
+}
+
+mutexADT mutexCreate(uint8_t recursive, int creatorPid) {
+    if (resourceCheck(creatorPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        return NULL;
+    }
+    mutexADT mutex = myMalloc(sizeof(struct mutexCDT));
+    if (mutex == NULL) {
+        return NULL;
+    }
+    mutex->owner = NULL;
+    mutex->depth = 0;
+    mutex->recursive = recursive ? 1 : 0;
+    waitQueueInit(&mutex->waiters);
+    mutex->held_next = NULL;
+    mutex->creatorPid = creatorPid;
+    resourceAdd(creatorPid, RESOURCE_SEMAPHORES, 1);
+    return mutex;
+}
+
+int mutexLock(mutexADT mutex) {
+    Process * current = getCurrentProcess();
+    if (mutex == NULL || current == NULL) {
+        return -1;
+    }
+
+    if (mutex->owner == NULL) {
+        grant(mutex, current);
+        return 0;
+    }
+    if (mutex->owner == current) {
+        if (!mutex->recursive) {
+            return -1;      // Would deadlock on itself
+        }
+        mutex->depth++;
+        return 0;
+    }
+
+    waitQueueAppend(&mutex->waiters, current);
+    sleepUntilOwner(mutex, current);
+    return 0;
+}
+
+int mutexTryLock(mutexADT mutex) {
+    Process * current = getCurrentProcess();
+    if (mutex == NULL || current == NULL) {
+        return -1;
+    }
+    if (mutex->owner != NULL && mutex->owner != current) {
+        return 1;
+    }
+    return mutexLock(mutex);
+}
+
+int mutexUnlock(mutexADT mutex) {
+    if (mutex == NULL || mutex->owner == NULL || mutex->owner != getCurrentProcess()) {
+        return -1;
+    }
+    if (--mutex->depth == 0) {
+        release(mutex);
+    }
+    return 0;
+}
+
+int mutexDestroy(mutexADT mutex) {
+    if (mutex == NULL || mutex->owner != NULL || mutex->waiters.count > 0) {
+        return -1;
+    }
+    resourceAdd(mutex->creatorPid, RESOURCE_SEMAPHORES, -1);
+    myFree(mutex);
+    return 0;
+}
+
+// The waiters get the mutex with whatever state the dead owner left behind, but they are not stuck forever
+void mutexReleaseAll(Process * process) {
+    if (process == NULL) {
+        return;
+    }
+    while (process->mutexes_held != NULL) {
+        release(process->mutexes_held);
+    }
+}
+
+condADT condCreate(int creatorPid) {
+    if (resourceCheck(creatorPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        return NULL;
+    }
+    condADT cond = myMalloc(sizeof(struct condCDT));
+    if (cond == NULL) {
+        return NULL;
+    }
+    waitQueueInit(&cond->waiters);
+    cond->mutex = NULL;
+    cond->creatorPid = creatorPid;
+    resourceAdd(creatorPid, RESOURCE_SEMAPHORES, 1);
+    return cond;
+}
+
+int condWait(condADT cond, mutexADT mutex) {
+    Process * current = getCurrentProcess();
+    if (cond == NULL || mutex == NULL || current == NULL || mutex->owner != current || mutex->depth != 1) {
+        return -1;
+    }
+    if (cond->mutex != NULL && cond->mutex != mutex) {
+        return -1;
+    }
+
+    cond->mutex = mutex;
+    waitQueueAppend(&cond->waiters, current);
+    release(mutex);
+    sleepUntilOwner(mutex, current);
+    return 0;
+}
+
+// Wait morphing: the waiter goes from the condition's queue to the mutex's without running in between,
+// it is only unblocked when the mutex is free to take
+static void morph(condADT cond, Process * waiter) {
+    mutexADT mutex = cond->mutex;
+    if (mutex->owner == NULL) {
+        grant(mutex, waiter);
+        unblock(waiter->pid);
+    } else {
+        waitQueueAppend(&mutex->waiters, waiter);
+    }
+}
+
+int condSignal(condADT cond) {
+    if (cond == NULL) {
+        return -1;
+    }
+    Process * waiter = waitQueuePop(&cond->waiters);
+    if (waiter != NULL) {
+        morph(cond, waiter);
+    }
+    if (cond->waiters.count == 0) {
+        cond->mutex = NULL;
+    }
+    return 0;
+}
+
+int condBroadcast(condADT cond) {
+    if (cond == NULL) {
+        return -1;
+    }
+    Process * waiter;
+    while ((waiter = waitQueuePop(&cond->waiters)) != NULL) {
+        morph(cond, waiter);
+    }
+    cond->mutex = NULL;
+    return 0;
+}
+
+int condDestroy(condADT cond) {
+    if (cond == NULL || cond->waiters.count > 0) {
+        return -1;
+    }
+    resourceAdd(cond->creatorPid, RESOURCE_SEMAPHORES, -1);
+    myFree(cond);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "rwlock.h"
+#include "waitQueue.h"
+#include "memory.h"
+#include "process.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+// Relies on running with interrupts off like mutex.c. Readers are only counted, so a process killed while
+// holding the lock leaves it held, as with a semaphore it never posted.
+
+struct rwlockCDT {
+    int readers;            // Readers inside
+    Process * writer;       // Writer inside, NULL if none
+    WaitQueue readWaiters;
+    WaitQueue writeWaiters;
+    int creatorPid;
+};
+
+// Processes are admitted by taking them out of the queue, a stray unblock finds them still queued
+static void sleepUntilAdmitted(WaitQueue * queue, Process * current) {
+    waitQueueAppend(queue, current);
+    do {
+        block(current->pid);
+    } while (current->wait_queue == queue);
+}
+
+static void admitWriter(rwlockADT lock) {
+    Process * writer = waitQueuePop(&lock->writeWaiters);
+    if (writer != NULL) {
+        lock->writer = writer;
+        unblock(writer->pid);
+    }
+}
+
+// Lets every queued reader in at once, they all run before the writers queued behind them
+static int admitReaders(rwlockADT lock) {
+    int admitted = 0;
+    Process * reader;
+    while ((reader = waitQueuePop(&lock->readWaiters)) != NULL) {
+        lock->readers++;
+        unblock(reader->pid);
+        admitted++;
+    }
+    return admitted;
+}
+
+rwlockADT rwlockCreate(int creatorPid) {
+    if (resourceCheck(creatorPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        return NULL;
+    }
+    rwlockADT lock = myMalloc(sizeof(struct rwlockCDT));
+    if (lock == NULL) {
+        return NULL;
+    }
+    lock->readers = 0;
+    lock->writer = NULL;
+    waitQueueInit(&lock->readWaiters);
+    waitQueueInit(&lock->writeWaiters);
+    lock->creatorPid = creatorPid;
+    resourceAdd(creatorPid, RESOURCE_SEMAPHORES, 1);
+    return lock;
+}
+
+int rwlockReadLock(rwlockADT lock) {
+    Process * current = getCurrentProcess();
+    if (lock == NULL || current == NULL || lock->writer == current) {
+        return -1;
+    }
+    if (lock->writer == NULL && lock->writeWaiters.count == 0) {
+        lock->readers++;
+        return 0;
+    }
+    sleepUntilAdmitted(&lock->readWaiters, current);
+    return 0;
+}
+
+int rwlockWriteLock(rwlockADT lock) {
+    Process * current = getCurrentProcess();
+    if (lock == NULL || current == NULL || lock->writer == current) {
+        return -1;
+    }
+    if (lock->writer == NULL && lock->readers == 0) {
+        lock->writer = current;
+        return 0;
+    }
+    sleepUntilAdmitted(&lock->writeWaiters, current);
+    return 0;
+}
+
+int rwlockUnlock(rwlockADT lock) {
+    Process * current = getCurrentProcess();
+    if (lock == NULL || current == NULL) {
+        return -1;
+    }
+
+    if (lock->writer == current) {
+        lock->writer = NULL;
+        if (admitReaders(lock) == 0) {
+            admitWriter(lock);
+        }
+        return 0;
+    }
+
+    if (lock->writer != NULL || lock->readers == 0) {
+        return -1;
+    }
+    if (--lock->readers == 0) {
+        admitWriter(lock);
+    }
+    return 0;
+}
+
+int rwlockDestroy(rwlockADT lock) {
+    if (lock == NULL || lock->readers > 0 || lock->writer != NULL
+        || lock->readWaiters.count > 0 || lock->writeWaiters.count > 0) {
+        return -1;
+    }
+    resourceAdd(lock->creatorPid, RESOURCE_SEMAPHORES, -1);
+    myFree(lock);
+    return 0;
+}
@@ -6,142 +6,201 @@
 #include "process.h"
 #include "scheduler.h"
 #include "panic.h"
-#include "queue.h"
 #include "strings.h"
+#include "lockStats.h"
+#include "waitQueue.h"
+
+#define SEM_REGISTRY_INITIAL_CAPACITY 64     // Power of two, rehashed when 3/4 of the slots are taken
+#define SEM_REGISTRY_EMPTY NULL
+#define SEM_REGISTRY_DELETED (&deletedSlot)  // Keeps probe chains intact after a removal
 
 struct semCDT {
-    char * name;
+    char * name;        // NULL for anonymous semaphores, which never enter the registry
     uint32_t count;
     uint8_t lock;
-    QueueADT blocked_processes;
+    WaitQueue waiters;  // Blocked processes in arrival order
+    int ownerPid;       // Process charged for the semaphore until it is destroyed
+    int refs;           // semInit calls on the name not yet matched by a semDestroy
+    int slot;           // Position in the registry, -1 when anonymous
 };
 
-// queueLock acts as a mutex for critical regions
-static QueueADT semaphoreQueue = NULL;
-uint8_t queueLock = 0;
-
-int cmpSem(void * sem_a, void * sem_b) {
-    semADT a = sem_a == NULL ? NULL : *((semADT *)sem_a);
-    semADT b = sem_b == NULL ? NULL : *((semADT *)sem_b);
-
-    if (a == b) {
-        return 0;
+// Named semaphores live in an open-addressing table keyed by name, probed linearly
+typedef struct {
+    semADT * slots;
+    int capacity;
+    int used;           // Live entries plus deleted markers, both lengthen the probes
+} SemRegistry;
+
+static struct semCDT deletedSlot;
+static SemRegistry registry = {NULL, 0, 0};
+
+// registryLock acts as a mutex for critical regions
+static uint8_t registryLock = 0;
+
+// FNV-1a
+static uint32_t hashName(const char *name) {
+    uint32_t hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
     }
+    return hash;
+}
 
-    if (a == NULL || b == NULL) {
-        return 1;
+// Slot holding the name, or the slot where it should be inserted (the first deleted one seen) when absent
+static int registryProbe(const char *name, int *found) {
+    int mask = registry.capacity - 1;
+    int index = hashName(name) & mask;
+    int insertAt = -1;
+    *found = 0;
+
+    for (int probes = 0; probes < registry.capacity; probes++, index = (index + 1) & mask) {
+        semADT entry = registry.slots[index];
+        if (entry == SEM_REGISTRY_EMPTY) {
+            return (insertAt >= 0) ? insertAt : index;
+        }
+        if (entry == SEM_REGISTRY_DELETED) {
+            if (insertAt < 0) {
+                insertAt = index;
+            }
+        } else if (strcmp(entry->name, name) == 0) {
+            *found = 1;
+            return index;
+        }
     }
+    return insertAt;
+}
 
-    if (a->name == NULL || b->name == NULL) {
-        return (a->name != b->name);
+// Rehashes into a table of the given capacity, dropping the deleted markers
+static int registryResize(int capacity) {
+    semADT * slots = myCalloc(capacity, sizeof(semADT));
+    if (slots == NULL) {
+        return -1;
     }
 
-    return strcmp(a->name, b->name);
-}
+    semADT * old = registry.slots;
+    int oldCapacity = registry.capacity;
+    registry.slots = slots;
+    registry.capacity = capacity;
+    registry.used = 0;
 
-static int cmpInt(void *a, void *b) {
-    return *((int *)a) - *((int *)b);
+    for (int i = 0; i < oldCapacity; i++) {
+        semADT entry = old[i];
+        if (entry == SEM_REGISTRY_EMPTY || entry == SEM_REGISTRY_DELETED) {
+            continue;
+        }
+        int found;
+        int slot = registryProbe(entry->name, &found);
+        registry.slots[slot] = entry;
+        entry->slot = slot;
+        registry.used++;
+    }
+    myFree(old);
+    return 0;
 }
 
-static semADT findSemaphoreByName(const char *name) {
-    if (name == NULL || semaphoreQueue == NULL || queueIsEmpty(semaphoreQueue)) {
-        return NULL;
-    }
+int initSemaphoreRegistry(void) {
+    lockStatsName(&registryLock, LOCK_KIND_SPINLOCK, "sem registry");
+    registry.slots = NULL;
+    registry.capacity = 0;
+    registry.used = 0;
+    return registryResize(SEM_REGISTRY_INITIAL_CAPACITY);
+}
 
-    if (queueBeginCyclicIter(semaphoreQueue) == NULL) {
+static semADT newSemaphore(uint32_t initial_count, int ownerPid) {
+    semADT sem = myMalloc(sizeof(struct semCDT));
+    if (sem == NULL) {
         return NULL;
     }
+    sem->name = NULL;
+    sem->count = initial_count;
+    sem->lock = 0;
+    sem->ownerPid = ownerPid;
+    sem->refs = 1;
+    sem->slot = -1;
+    waitQueueInit(&sem->waiters);
+    return sem;
+}
 
-    semADT current = NULL;
-    int size = queueSize(semaphoreQueue);
-
-    for (int i = 0; i < size; i++) {
-        queueNextCyclicIter(semaphoreQueue, &current);
-        if (strcmp(current->name, name) == 0) {
-            return current;
-        }
-    }
-
-    return NULL;
+static void freeSemaphore(semADT sem) {
+    // Unblock all processes waiting on this semaphore
+    waitQueueWakeAll(&sem->waiters);
+    resourceAdd(sem->ownerPid, RESOURCE_SEMAPHORES, -1);
+    lockStatsForget(sem);
+    lockStatsForget(&sem->lock);
+    myFree(sem->name);
+    myFree(sem);
 }
 
-int initSemaphoreQueue(void) {
-    semaphoreQueue = createQueue(cmpSem, sizeof(semADT));
-    if (semaphoreQueue == NULL) {
-        return -1;
-    }
-    return 0;
+semADT semCreate(uint32_t initial_count){
+    return newSemaphore(initial_count, -1);
 }
 
 semADT semInit(const char *name, uint32_t initial_count){
+    return semInitOwned(name, initial_count, -1);
+}
+
+semADT semInitOwned(const char *name, uint32_t initial_count, int ownerPid){
     if (name == NULL) {
         return NULL;
     }
 
-    if (semaphoreQueue == NULL) {
-        QueueADT newQueue = createQueue(cmpSem, sizeof(semADT));
-        if (newQueue == NULL) {
-            return NULL;
-        }
-
-        semLock(&queueLock);
-        if (semaphoreQueue == NULL) {
-            semaphoreQueue = newQueue;
-            newQueue = NULL;
-        }
-        semUnlock(&queueLock);
-
-        if (newQueue != NULL) {
-            queueFree(newQueue);
-        }
+    semLock(&registryLock);
+    if (registry.slots == NULL && registryResize(SEM_REGISTRY_INITIAL_CAPACITY) != 0) {
+        semUnlock(&registryLock);
+        return NULL;
     }
 
-    semLock(&queueLock);
-    semADT existing = findSemaphoreByName(name);
-    if (existing != NULL) {
-        semUnlock(&queueLock);
+    int found;
+    int slot = registryProbe(name, &found);
+    if (found) {
+        semADT existing = registry.slots[slot];
+        existing->refs++;
+        semUnlock(&registryLock);
         return existing;
     }
-    semUnlock(&queueLock);
 
-    semADT sem = myMalloc(sizeof(struct semCDT));
-    if (sem == NULL) {
+    // Opening an existing semaphore is free, only the process that creates it is charged
+    if (resourceCheck(ownerPid, RESOURCE_SEMAPHORES, 1) != 0) {
+        semUnlock(&registryLock);
         return NULL;
     }
 
+    semADT sem = newSemaphore(initial_count, ownerPid);
+    if (sem == NULL) {
+        semUnlock(&registryLock);
+        return NULL;
+    }
+    resourceAdd(ownerPid, RESOURCE_SEMAPHORES, 1);
     sem->name = myMalloc(strlen(name) + 1);
     if (sem->name == NULL) {
-        myFree(sem);
+        freeSemaphore(sem);
+        semUnlock(&registryLock);
         return NULL;
     }
     strcpy(sem->name, name);
-    sem->count = initial_count;
-    sem->lock = 0;
-    sem->blocked_processes = createQueue(cmpInt, sizeof(int));
-    if( sem->blocked_processes == NULL) {
-        myFree(sem->name);
-        myFree(sem);
-        return NULL;
-    }
 
-    semLock(&queueLock);
-    existing = findSemaphoreByName(name);
-    if (existing != NULL) {
-        semUnlock(&queueLock);
-        queueFree(sem->blocked_processes);
-        myFree(sem->name);
-        myFree(sem);
-        return existing;
+    if ((registry.used + 1) * 4 > registry.capacity * 3) {
+        // Grows only when live entries fill half the table, otherwise sweeping the deleted markers is enough
+        int live = 0;
+        for (int i = 0; i < registry.capacity; i++) {
+            live += (registry.slots[i] != SEM_REGISTRY_EMPTY && registry.slots[i] != SEM_REGISTRY_DELETED);
+        }
+        int capacity = (live * 2 >= registry.capacity) ? registry.capacity * 2 : registry.capacity;
+        if (registryResize(capacity) != 0) {
+            freeSemaphore(sem);
+            semUnlock(&registryLock);
+            return NULL;
+        }
+        slot = registryProbe(name, &found);
     }
 
-    if (enqueue(semaphoreQueue, &sem) == NULL) {
-        semUnlock(&queueLock);
-        queueFree(sem->blocked_processes);
-        myFree(sem->name);
-        myFree(sem);
-        return NULL;
+    if (registry.slots[slot] == SEM_REGISTRY_EMPTY) {
+        registry.used++;
     }
-    semUnlock(&queueLock);
+    registry.slots[slot] = sem;
+    sem->slot = slot;
+    semUnlock(&registryLock);
     return sem;
 }
 
@@ -150,15 +209,15 @@ int post(semADT sem){
         return -1;
     }
 
+    lockStatsSemPosted(sem);
     semLock(&sem->lock);
-    if(queueIsEmpty(sem->blocked_processes)) {
+    Process * waiter = waitQueuePop(&sem->waiters);
+    if (waiter == NULL) {
         sem->count++;
         semUnlock(&sem->lock);
     } else {
-        int pid;
-        dequeue(sem->blocked_processes, &pid);
         semUnlock(&sem->lock);
-        unblock(pid);
+        unblock(waiter->pid);
         // Yield to give the newly unblocked process a chance to run immediately
         // This is especially important for semaphores where the unblocked process
         // is likely waiting for the same resource we just released
@@ -172,38 +231,47 @@ int wait(semADT sem){
         return -1;
     }
 
+    uint64_t start = lockStatsStart();
     semLock(&sem->lock);
     if (sem->count > 0) {
         sem->count--;
         semUnlock(&sem->lock);
+        lockStatsSemWaited(lockStatsSemWaiting(sem, sem->name, 0), sem, start);
     } else {
+        // semDestroy may free sem while this process sleeps, so the wait is counted before blocking
+        LockStatsEntry * stats = lockStatsSemWaiting(sem, sem->name, 1);
+        // The PCB is the wait node, so blocking never allocates and cannot fail on a full heap
         Process * currentProcess = getCurrentProcess();
-        int pid = currentProcess->pid;
-        enqueue(sem->blocked_processes, &pid);
+        waitQueueAppend(&sem->waiters, currentProcess);
         semUnlock(&sem->lock);
-        block(pid);
+        // Only a post or a wake takes the PCB out of the queue, a stray unblock (the block command) must
+        // not return while it is still linked there
+        do {
+            block(currentProcess->pid);
+        } while (currentProcess->wait_queue == &sem->waiters);
+        lockStatsSemWaited(stats, sem, start);
     }
     return 0;
 }
 
+// Drops one reference, the semaphore goes away with the last one
 void semDestroy(semADT sem){
     if (sem == NULL) {
         return;
     }
 
-    semLock(&queueLock);
-    queueRemove(semaphoreQueue, &sem);
-    semUnlock(&queueLock);
-
-    // Unblock all processes waiting on this semaphore
-    while (!queueIsEmpty(sem->blocked_processes)) {
-        int pid;
-        dequeue(sem->blocked_processes, &pid);
-        unblock(pid); 
+    semLock(&registryLock);
+    if (--sem->refs > 0) {
+        semUnlock(&registryLock);
+        return;
     }
-    queueFree(sem->blocked_processes);
-    myFree(sem->name);
-    myFree(sem);
+    if (sem->slot >= 0) {
+        registry.slots[sem->slot] = SEM_REGISTRY_DELETED;
+        sem->slot = -1;
+    }
+    semUnlock(&registryLock);
+
+    freeSemaphore(sem);
 }
 
 int semGetBlockedCount(semADT sem) {
@@ -211,18 +279,25 @@ int semGetBlockedCount(semADT sem) {
         return -1;
     }
     semLock(&sem->lock);
-    int count = queueSize(sem->blocked_processes);
+    int count = sem->waiters.count;
     semUnlock(&sem->lock);
     return count;
 }
 
-void wakeBlocked(semADT sem) {
+int semWakeAll(semADT sem) {
     if (sem == NULL) {
-        return;
+        return 0;
     }
 
-    int blocked = semGetBlockedCount(sem);
-    while (blocked-- > 0) {
-        post(sem);
+    // Empties the queue under one lock, the waiters return from wait as if each got its own post
+    semLock(&sem->lock);
+    int woken = waitQueueWakeAll(&sem->waiters);
+    semUnlock(&sem->lock);
+    return woken;
+}
+
+void wakeBlocked(semADT sem) {
+    if (semWakeAll(sem) > 0) {
+        yield();
     }
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "waitQueue.h"
+#include "process.h"
+#include <stddef.h>
+
+void waitQueueInit(WaitQueue * queue) {
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0;
+}
+
+void waitQueueAppend(WaitQueue * queue, Process * process) {
+    process->wait_next = NULL;
+    process->wait_prev = queue->tail;
+    if (queue->tail != NULL) {
+        queue->tail->wait_next = process;
+    } else {
+        queue->head = process;
+    }
+    queue->tail = process;
+    process->wait_queue = queue;
+    queue->count++;
+}
+
+void waitQueueUnlink(WaitQueue * queue, Process * process) {
+    if (process->wait_prev != NULL) {
+        process->wait_prev->wait_next = process->wait_next;
+    } else {
+        queue->head = process->wait_next;
+    }
+    if (process->wait_next != NULL) {
+        process->wait_next->wait_prev = process->wait_prev;
+    } else {
+        queue->tail = process->wait_prev;
+    }
+    process->wait_next = NULL;
+    process->wait_prev = NULL;
+    process->wait_queue = NULL;
+    queue->count--;
+}
+
+Process * waitQueuePop(WaitQueue * queue) {
+    Process * process = queue->head;
+    if (process != NULL) {
+        waitQueueUnlink(queue, process);
+    }
+    return process;
+}
+
+int waitQueueWakeAll(WaitQueue * queue) {
+    Process * process = queue->head;
+    int woken = queue->count;
+    waitQueueInit(queue);
+
+    while (process != NULL) {
+        Process * next = process->wait_next;
+        process->wait_next = NULL;
+        process->wait_prev = NULL;
+        process->wait_queue = NULL;
+        unblock(process->pid);
+        process = next;
+    }
+    return woken;
+}
+
+void waitQueueCancel(Process * process) {
+    if (process == NULL || process->wait_queue == NULL) {
+        return;
+    }
+    waitQueueUnlink(process->wait_queue, process);
+}
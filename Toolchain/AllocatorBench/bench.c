@@ -0,0 +1,373 @@
+// Host benchmark for the kernel allocators.
+// The same file is linked once per allocator (bench_buddy, bench_bitmap, bench_tlsf) and runs
+// a set of synthetic workloads plus, optionally, traces recorded with MEMORY_TRACE=1.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "memory.h"
+
+#ifndef ALLOCATOR_NAME
+#define ALLOCATOR_NAME "unknown"
+#endif
+
+#define DEFAULT_OPERATIONS 200000
+#define SAMPLE_INTERVAL 64              // Operations between fragmentation samples
+
+#define LIFO_DEPTH 256
+#define FIFO_DEPTH 256
+#define RANDOM_SLOTS 1024
+#define PROCESS_SLOTS 32
+#define PROCESS_STACK_SIZE 4096
+#define PROCESS_PCB_SIZE 256
+#define PROCESS_EXTRA_ALLOCATIONS 4
+
+#define TRACE_HEAP_SPAN (1 << 20)       // Kernel pointers in a trace all fall inside the 512K heap
+#define TRACE_SLOTS (2 * TRACE_HEAP_SPAN / 8)
+
+typedef struct Run {
+    uint64_t rng;
+    long operations;
+    long allocations;
+    long failures;
+    int sampling;                       // Only the untimed pass measures fragmentation
+    int peak_external;                  // Percentage of free memory unusable for the biggest request
+    int peak_internal;                  // Bytes reserved beyond the requests
+} Run;
+
+typedef struct Workload {
+    const char *name;
+    void (*run)(Run *run, long operations);
+} Workload;
+
+// ========== Instrumented calls ==========
+static uint32_t next_random(Run *run) {
+    run->rng ^= run->rng << 13;
+    run->rng ^= run->rng >> 7;
+    run->rng ^= run->rng << 17;
+    return (uint32_t)(run->rng >> 16);
+}
+
+static void sample(Run *run) {
+    if (!run->sampling || run->operations % SAMPLE_INTERVAL != 0) {
+        return;
+    }
+
+    MemoryStats stats;
+    memstatsExtended(&stats);
+    if (stats.used > 0 && stats.available > 0) {
+        int external = 100 - (int)((long)stats.largestFreeBlock * 100 / stats.available);
+        if (external > run->peak_external) {
+            run->peak_external = external;
+        }
+    }
+    if (stats.internalFragmentation > run->peak_internal) {
+        run->peak_internal = stats.internalFragmentation;
+    }
+}
+
+static void *bench_malloc(Run *run, int size, int owner) {
+    void *ptr = myMallocOwned(size, owner);
+    run->operations++;
+    run->allocations++;
+    if (ptr == NULL) {
+        run->failures++;
+    }
+    sample(run);
+    return ptr;
+}
+
+static void bench_free(Run *run, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    myFree(ptr);
+    run->operations++;
+    sample(run);
+}
+
+static void bench_free_owner(Run *run, int owner) {
+    myFreeOwnedBy(owner);
+    run->operations++;
+    sample(run);
+}
+
+// Mostly small requests with an occasional large one, like the kernel and shell see
+static int random_size(Run *run) {
+    uint32_t r = next_random(run);
+    if (r % 8 == 0) {
+        return 1024 + (int)(next_random(run) % 8192);
+    }
+    return 8 + (int)(next_random(run) % 248);
+}
+
+// ========== Synthetic workloads ==========
+// Grows a stack of blocks and releases it in reverse order
+static void run_lifo(Run *run, long operations) {
+    void *stack[LIFO_DEPTH];
+    while (run->operations < operations) {
+        int depth = 0;
+        while (depth < LIFO_DEPTH && run->operations < operations) {
+            stack[depth++] = bench_malloc(run, random_size(run), 1);
+        }
+        while (depth > 0) {
+            bench_free(run, stack[--depth]);
+        }
+    }
+}
+
+// Keeps a window of live blocks and always releases the oldest one
+static void run_fifo(Run *run, long operations) {
+    void *queue[FIFO_DEPTH] = {0};
+    int head = 0;
+    while (run->operations < operations) {
+        bench_free(run, queue[head]);
+        queue[head] = bench_malloc(run, random_size(run), 1);
+        head = (head + 1) % FIFO_DEPTH;
+    }
+    for (int i = 0; i < FIFO_DEPTH; i++) {
+        bench_free(run, queue[i]);
+    }
+}
+
+// Allocates or releases a random slot on every step
+static void run_random(Run *run, long operations) {
+    void *slots[RANDOM_SLOTS] = {0};
+    while (run->operations < operations) {
+        int slot = (int)(next_random(run) % RANDOM_SLOTS);
+        if (slots[slot] != NULL) {
+            bench_free(run, slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            slots[slot] = bench_malloc(run, random_size(run), 1);
+        }
+    }
+    for (int i = 0; i < RANDOM_SLOTS; i++) {
+        bench_free(run, slots[i]);
+    }
+}
+
+// Processes come and go: each one reserves a PCB, a stack and a few buffers, and
+// everything it owns is reclaimed at once when it dies, as removeProcess does
+static void run_process_stacks(Run *run, long operations) {
+    int alive[PROCESS_SLOTS] = {0};
+    while (run->operations < operations) {
+        int slot = (int)(next_random(run) % PROCESS_SLOTS);
+        if (alive[slot]) {
+            bench_free_owner(run, slot + 1);
+            alive[slot] = 0;
+            continue;
+        }
+
+        bench_malloc(run, PROCESS_PCB_SIZE, slot + 1);
+        bench_malloc(run, PROCESS_STACK_SIZE, slot + 1);
+        for (int i = 0; i < PROCESS_EXTRA_ALLOCATIONS; i++) {
+            bench_malloc(run, 8 + (int)(next_random(run) % 120), slot + 1);
+        }
+        alive[slot] = 1;
+    }
+    for (int i = 0; i < PROCESS_SLOTS; i++) {
+        if (alive[i]) {
+            bench_free_owner(run, i + 1);
+        }
+    }
+}
+
+static const Workload workloads[] = {
+    {"lifo", run_lifo},
+    {"fifo", run_fifo},
+    {"random", run_random},
+    {"stacks", run_process_stacks},
+};
+
+// ========== Trace replay ==========
+typedef struct TraceOp {
+    int size;       // 0 for a free
+    int slot;       // Block the operation refers to, -1 when the allocation failed in the kernel
+} TraceOp;
+
+static TraceOp *trace_ops = NULL;
+static long trace_count = 0;
+static int trace_blocks = 0;
+
+// Resolves every kernel pointer to a block index so the replay does not need a lookup table
+static int load_trace(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    int *live = malloc(sizeof(int) * TRACE_SLOTS);
+    long capacity = 1024;
+    trace_ops = malloc(sizeof(TraceOp) * capacity);
+    if (live == NULL || trace_ops == NULL) {
+        fclose(file);
+        free(live);
+        return -1;
+    }
+    for (int i = 0; i < TRACE_SLOTS; i++) {
+        live[i] = -1;
+    }
+
+    unsigned long base = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char kind;
+        unsigned long size = 0, ptr = 0;
+        if (sscanf(line, "a %lx %lx", &size, &ptr) == 2) {
+            kind = 'a';
+        } else if (sscanf(line, "f %lx", &ptr) == 1) {
+            kind = 'f';
+        } else {
+            continue;   // The debug console may carry other output
+        }
+
+        if (ptr != 0 && base == 0) {
+            base = ptr - TRACE_HEAP_SPAN / 2;
+        }
+        long index = ptr != 0 ? (long)(ptr - base) / 8 : -1;
+        if (ptr != 0 && (ptr < base || index >= TRACE_SLOTS)) {
+            continue;
+        }
+
+        if (trace_count == capacity) {
+            capacity *= 2;
+            TraceOp *grown = realloc(trace_ops, sizeof(TraceOp) * capacity);
+            if (grown == NULL) {
+                fclose(file);
+                free(live);
+                return -1;
+            }
+            trace_ops = grown;
+        }
+
+        TraceOp *op = &trace_ops[trace_count];
+        if (kind == 'a') {
+            op->size = size > 0 ? (int)size : 1;
+            op->slot = -1;
+            if (index >= 0) {
+                op->slot = trace_blocks++;
+                live[index] = op->slot;
+            }
+            trace_count++;
+        } else if (index >= 0 && live[index] >= 0) {
+            op->size = 0;
+            op->slot = live[index];
+            live[index] = -1;
+            trace_count++;
+        }
+    }
+
+    fclose(file);
+    free(live);
+    return 0;
+}
+
+static void run_trace(Run *run, long operations) {
+    (void)operations;
+    void **blocks = calloc(trace_blocks > 0 ? trace_blocks : 1, sizeof(void *));
+    if (blocks == NULL) {
+        return;
+    }
+
+    for (long i = 0; i < trace_count; i++) {
+        TraceOp *op = &trace_ops[i];
+        if (op->size > 0) {
+            void *ptr = bench_malloc(run, op->size, 1);
+            if (op->slot >= 0) {
+                blocks[op->slot] = ptr;
+            } else {
+                bench_free(run, ptr);   // Failed in the kernel, keep the heaps comparable
+            }
+        } else {
+            bench_free(run, blocks[op->slot]);
+            blocks[op->slot] = NULL;
+        }
+    }
+    for (int i = 0; i < trace_blocks; i++) {
+        bench_free(run, blocks[i]);
+    }
+    free(blocks);
+}
+
+// ========== Driver ==========
+static double elapsed_seconds(struct timespec *start, struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Runs the workload twice from a fresh heap: once timed, once sampling fragmentation
+static void bench(const Workload *workload, long operations, uint64_t seed) {
+    Run timed = {.rng = seed};
+    struct timespec start, end;
+
+    initMemory();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    workload->run(&timed, operations);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    MemoryStats stats;
+    memstatsExtended(&stats);
+
+    Run sampled = {.rng = seed, .sampling = 1};
+    initMemory();
+    workload->run(&sampled, operations);
+
+    double seconds = elapsed_seconds(&start, &end);
+    printf("%-8s %-8s %10ld %12.0f %8.2f%% %9d%% %12d %10lu %10lu\n",
+           ALLOCATOR_NAME, workload->name, timed.operations,
+           seconds > 0 ? timed.operations / seconds : 0.0,
+           timed.allocations > 0 ? 100.0 * timed.failures / timed.allocations : 0.0,
+           sampled.peak_external, sampled.peak_internal,
+           (unsigned long)stats.maxMallocCycles, (unsigned long)stats.maxFreeCycles);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-n operations] [-s seed] [-t trace]...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    long operations = DEFAULT_OPERATIONS;
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    const char *traces[16];
+    int trace_files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            operations = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+            if (seed == 0) {
+                seed = 1;
+            }
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc && trace_files < 16) {
+            traces[trace_files++] = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-8s %-8s %10s %12s %9s %10s %12s %10s %10s\n",
+           "alloc", "workload", "ops", "ops/sec", "failed", "peak ext", "peak int (B)", "max malloc", "max free");
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        bench(&workloads[i], operations, seed);
+    }
+
+    for (int i = 0; i < trace_files; i++) {
+        trace_count = 0;
+        trace_blocks = 0;
+        free(trace_ops);
+        trace_ops = NULL;
+        if (load_trace(traces[i]) != 0) {
+            return 1;
+        }
+        Workload replay = {"trace", run_trace};
+        bench(&replay, trace_count, seed);
+    }
+
+    free(trace_ops);
+    return 0;
+}
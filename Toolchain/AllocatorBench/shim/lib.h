@@ -0,0 +1,18 @@
+#ifndef LIB_H
+#define LIB_H
+
+// Host stand-in for Kernel/include/lib.h so the allocators build as regular Linux objects
+
+#include <stdint.h>
+#include <string.h>
+
+static inline uint64_t _rdtsc(void) {
+    return __builtin_ia32_rdtsc();
+}
+
+static inline void _outb(uint16_t port, uint8_t value) {
+    (void)port;
+    (void)value;
+}
+
+#endif
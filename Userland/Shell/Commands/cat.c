@@ -1,6 +1,8 @@
 
 #include "commands.h"
 
+#define CAT_SPLICE_SIZE 4096
+
 int _cat(int argc, char **argv) {
     if (argc != 1) {
         fprintf(FD_STDERR, "Usage: cat\n");
@@ -8,10 +10,19 @@ int _cat(int argc, char **argv) {
     }
 
     int printed = 0;
-    int ch;
-    while ((ch = getchar()) != -1) {
-        putchar((char)ch);
-        printed = 1;
+    // Piped input goes straight to the output without passing through this process
+    int moved = splice(FD_STDIN, FD_STDOUT, CAT_SPLICE_SIZE);
+    if (moved >= 0) {
+        while (moved > 0) {
+            printed = 1;
+            moved = splice(FD_STDIN, FD_STDOUT, CAT_SPLICE_SIZE);
+        }
+    } else {
+        int ch;
+        while ((ch = getchar()) != -1) {
+            putchar((char)ch);
+            printed = 1;
+        }
     }
 
     if (printed) {
@@ -32,6 +32,9 @@ int _regs(int argc, char **argv);
 int _shell_kill(int argc, char **argv);
 int _snake(int argc, char **argv);
 int _time(int argc, char **argv);
+int _top(int argc, char **argv);
+int _lockstat(int argc, char **argv);
+int _ulimit(int argc, char **argv);
 int _wc(int argc, char **argv);
 
 // Tests
@@ -40,5 +43,12 @@ int _test_prio(int argc, char ** argv);
 int _test_processes(int argc, char ** argv);
 int _test_sync(int argc, char ** argv);
 int _test_wait_children(int argc, char ** argv);
+int _test_threads(int argc, char ** argv);
+int _test_spawn(int argc, char ** argv);
+int _test_sem(int argc, char ** argv);
+int _test_cond(int argc, char ** argv);
+int _test_rwlock(int argc, char ** argv);
+int _test_barrier(int argc, char ** argv);
+int _test_pipe(int argc, char ** argv);
 
 #endif
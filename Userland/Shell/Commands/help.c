@@ -34,10 +34,10 @@ int _help(int argc, char * argv[]){
     }
     char *basic_commands[] = {
         "block", "cat", "clear", "divzero", "echo", "exit", "filter", "font", "getpid", "help",
-        "history", "invop", "kill", "man", "mem", "mvar", "nice", "ps", "regs", "snake", "time", "wc"
+        "history", "invop", "kill", "lockstat", "man", "mem", "mvar", "nice", "ps", "regs", "snake", "time", "top", "ulimit", "wc"
     };
 	char *test_commands[] = {
-		"test_mm", "test_prio", "test_processes", "test_sync", "test_wait_children"
+		"test_barrier", "test_cond", "test_mm", "test_pipe", "test_prio", "test_processes", "test_rwlock", "test_sem", "test_spawn", "test_sync", "test_threads", "test_wait_children"
 	};
 
     printf("Available commands:\n\n");
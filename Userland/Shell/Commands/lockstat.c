@@ -0,0 +1,51 @@
+#include "commands.h"
+
+#define LOCKSTAT_DEFAULT_ROWS 16
+
+static char * kindName(uint8_t kind) {
+    return kind == LOCK_KIND_SEMAPHORE ? "sem" : "spin";
+}
+
+int _lockstat(int argc, char * argv[]) {
+    int rows = LOCKSTAT_DEFAULT_ROWS;
+    if (argc > 2 || (argc == 2 && (sscanf(argv[1], "%d", &rows) != 1 || rows <= 0 || rows > LOCK_STATS_MAX))) {
+        perror("Usage: lockstat [rows]\n");
+        return 1;
+    }
+
+    LockStatsEntry * entries = myMalloc(sizeof(LockStatsEntry) * rows);
+    if (entries == NULL) {
+        perror("lockstat: not enough memory\n");
+        return 1;
+    }
+
+    int count = lockStats(entries, rows);
+    if (count < 0) {
+        perror("lockstat: kernel built without lock profiling, compile with LOCK_STATS=1\n");
+        myFree(entries);
+        return 1;
+    }
+
+    // Sorted by total wait, cycles are shown in thousands to fit the columns
+    printf("Name\t\tKind\tAcq\tCont\tSpins\tWait(k)\tMax(k)\tHolder\n");
+    for (int i = 0; i < count; i++) {
+        LockStatsEntry * entry = &entries[i];
+        if (entry->name[0] != '\0') {
+            printf("%s\t%s", entry->name, strlen(entry->name) < 8 ? "\t" : "");
+        } else {
+            printf("0x%x\t", (uint32_t)entry->address);
+        }
+        printf("%s\t%d\t%d\t%d\t%d\t%d\t", kindName(entry->kind), (int)entry->acquisitions, (int)entry->contended,
+               (int)entry->spins, (int)(entry->waitCycles / 1000), (int)(entry->maxWaitCycles / 1000));
+        if (entry->address == 0) {
+            printf("freed\n");
+        } else if (entry->holderPid < 0) {
+            printf("-\n");
+        } else {
+            printf("%d\n", entry->holderPid);
+        }
+    }
+
+    myFree(entries);
+    return 0;
+}
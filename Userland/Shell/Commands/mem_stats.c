@@ -3,20 +3,69 @@
 #include "commands.h"
 
 int _mem_stats(int argc, char * argv[]) {
-    if (argc > 1) {
-		perror("Usage: mem\n");
+    if (argc > 2) {
+		perror("Usage: mem [pid]\n");
 		return 1;
 	}
 
-    int total = 0, used = 0, available = 0;
-    
-    mem(&total, &used, &available);
+    if (argc == 2) {
+        int pid = satoi(argv[1]);
+        int owned = memByPid(pid);
+        if (owned < 0) {
+            fprintf(FD_STDERR, "mem: no process with pid %s\n", argv[1]);
+            return 1;
+        }
+        printf("Process %d uses %d bytes (%d KB) of heap\n", pid, owned, owned / 1024);
+        return 0;
+    }
+
+    MemoryStats stats;
+    if (memExtended(&stats) != 0) {
+        perror("mem: syscall failed\n");
+        return 1;
+    }
+
+    int total = stats.total, used = stats.used, available = stats.available;
     
     printf("\n\e[0;36m=== Memory Statistics ===\e[0m\n");
     printf("Total memory:     %d bytes (%d KB)\n", total, total / 1024);
     printf("Used memory:      %d bytes (%d KB)\n", used, used / 1024);
     printf("Available memory: %d bytes (%d KB)\n", available, available / 1024);
     printf("Usage: %d%%\n\n", total > 0 ? (used * 100) / total : 0);
+
+    printf("\e[0;36m=== Fragmentation ===\e[0m\n");
+    printf("Largest free block:     %d bytes\n", stats.largestFreeBlock);
+    printf("Internal fragmentation: %d bytes\n", stats.internalFragmentation);
+    printf("External fragmentation: %d%%\n", available > 0 ? 100 - (stats.largestFreeBlock * 100) / available : 0);
+    printf("Allocations: %d  Frees: %d  Failures: %d\n\n", stats.allocationCount, stats.freeCount, stats.failedCount);
+
+    uint32_t mallocCalls = stats.allocationCount + stats.failedCount;
+    printf("\e[0;36m=== Latency (cycles) ===\e[0m\n");
+    printf("malloc: avg %d  max %d\n", mallocCalls > 0 ? (int)(stats.mallocCycles / mallocCalls) : 0, (int)stats.maxMallocCycles);
+    printf("free:   avg %d  max %d\n\n", stats.freeCount > 0 ? (int)(stats.freeCycles / stats.freeCount) : 0, (int)stats.maxFreeCycles);
+
+    StackCacheStats stacks;
+    if (stackCacheStats(&stacks) == 0) {
+        uint32_t lookups = stacks.hits + stacks.misses;
+        printf("\e[0;36m=== Stack cache ===\e[0m\n");
+        printf("Hits: %d  Misses: %d  Hit rate: %d%%\n", stacks.hits, stacks.misses, lookups > 0 ? (int)(stacks.hits * 100 / lookups) : 0);
+        printf("Cached: %d  Released: %d  High-water: %d per size\n", stacks.cached, stacks.released, stacks.highWater);
+        printf("Deepest stack at exit: %d bytes  Exhausted stacks: %d\n\n", stacks.peakUsage, stacks.exhausted);
+    }
+
+    printf("Size class\tFree blocks\tRequests\n");
+    for (int i = 0; i < MEMORY_STATS_CLASSES; i++) {
+        if (stats.freeBlocks[i] == 0 && stats.requestSizes[i] == 0) {
+            continue;
+        }
+        int class_size = MEMORY_STATS_MIN_CLASS_SIZE << i;
+        if (class_size >= 1024) {
+            printf("%d KB\t\t%d\t\t%d\n", class_size / 1024, stats.freeBlocks[i], stats.requestSizes[i]);
+        } else {
+            printf("%d B\t\t%d\t\t%d\n", class_size, stats.freeBlocks[i], stats.requestSizes[i]);
+        }
+    }
+    printf("\n");
     
     return 0;
 }
\ No newline at end of file
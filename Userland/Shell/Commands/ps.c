@@ -1,20 +1,30 @@
 
 #include "commands.h"
 
+#define PS_EXTRA_ENTRIES 8
+
 int _ps(int argc, char * argv[]){ 
     if (argc > 1) {
 		perror("Usage: ps\n");
 		return 1;
 	}
 
-    static ProcessInformation processInfo[64];
-    int count = ps(processInfo);
+    // Leaves room for processes created between both calls
+    int capacity = ps(NULL, 0) + PS_EXTRA_ENTRIES;
+    ProcessInformation * processInfo = myMalloc(sizeof(ProcessInformation) * capacity);
+    if (processInfo == NULL) {
+        perror("ps: not enough memory\n");
+        return 1;
+    }
+    int count = ps(processInfo, capacity);
     if (count < 0){
         perror("ps: syscall failed\n");
+        myFree(processInfo);
         return count;
     }
     if (count == 0){
         printf("No processes found\n");
+        myFree(processInfo);
         return 0;
     }
 
@@ -60,7 +70,7 @@ int _ps(int argc, char * argv[]){
     }
     padding_state_header[j] = '\0';
 
-	printf("\e[0;0mPID\tName%sState%sPriority\tRSP\t\tRBP\t\tIn FG\n",
+	printf("\e[0;0mPID\tName%sState%sPriority\tRSP\t\tRBP\t\tStack\t\tHeap\tP/S\tIn FG\n",
 	       padding_header, padding_state_header);
 
     for (int i = 0; i < count; i++) {
@@ -99,9 +109,13 @@ int _ps(int argc, char * argv[]){
         unsigned int rsp = (unsigned int)(uintptr_t)processInfo[i].rsp;
         unsigned int stack_base = (unsigned int)(uintptr_t)processInfo[i].stack_base;
 
-        printf("%d\t%s%s%s%s%s%s%d\t\t0x%x\t0x%x\t%s\n",
+        ResourceUsage * resources = &processInfo[i].resources;
+        printf("%d\t%s%s%s%s%s%s%d\t\t0x%x\t0x%x\t%d/%d\t%d\t%d/%d\t%s\n",
 			   processInfo[i].pid, name, padding, state_color, state_name, reset, state_padding,
-			   processInfo[i].priority, rsp, stack_base, processInfo[i].is_foreground ? "Yes" : "No");
+			   processInfo[i].priority, rsp, stack_base, processInfo[i].stack_used, processInfo[i].stack_size,
+			   resources->usage[RESOURCE_HEAP], resources->usage[RESOURCE_PIPES], resources->usage[RESOURCE_SEMAPHORES],
+			   processInfo[i].is_foreground ? "Yes" : "No");
 	}
+    myFree(processInfo);
 	return 0;
 }
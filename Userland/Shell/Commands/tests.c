@@ -42,7 +42,7 @@ int _test_prio(int argc, char **argv) {
 
 int _test_sync(int argc, char **argv) {
 	if (argc != 3) {
-		fprintf(FD_STDERR, "Usage: test_sync <iterations> <use_semaphore:0|1>\n");
+		fprintf(FD_STDERR, "Usage: test_sync <iterations> <use_semaphore:0|1|2|3>\n");
 		return 1;
 	}
 
@@ -50,6 +50,36 @@ int _test_sync(int argc, char **argv) {
 	return report_failure(argv[0], status);
 }
 
+int _test_threads(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_threads [worker_count]\n");
+		return 1;
+	}
+
+	int64_t status = test_threads((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
+int _test_spawn(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_spawn [process_count]\n");
+		return 1;
+	}
+
+	int64_t status = test_spawn((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
+int _test_sem(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_sem [rounds]\n");
+		return 1;
+	}
+
+	int64_t status = test_sem((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
 int _test_wait_children(int argc, char **argv) {
 	if (argc > 2) {
 		fprintf(FD_STDERR, "Usage: test_wait_children [child_count]\n");
@@ -59,3 +89,43 @@ int _test_wait_children(int argc, char **argv) {
 	int64_t status = (int64_t)test_wait_children((uint64_t)argc, argv);
 	return report_failure(argv[0], status);
 }
+
+int _test_cond(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_cond [consumer_count]\n");
+		return 1;
+	}
+
+	int64_t status = test_cond((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
+int _test_rwlock(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_rwlock [max_readers]\n");
+		return 1;
+	}
+
+	int64_t status = test_rwlock((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
+int _test_barrier(int argc, char **argv) {
+	if (argc > 2) {
+		fprintf(FD_STDERR, "Usage: test_barrier [worker_count]\n");
+		return 1;
+	}
+
+	int64_t status = test_barrier((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
+
+int _test_pipe(int argc, char **argv) {
+	if (argc > 3) {
+		fprintf(FD_STDERR, "Usage: test_pipe [kilobytes] [stages]\n");
+		return 1;
+	}
+
+	int64_t status = test_pipe((uint64_t)argc, argv);
+	return report_failure(argv[0], status);
+}
@@ -0,0 +1,111 @@
+#include "commands.h"
+
+#define TOP_MAX_ENTRIES 128
+#define TOP_DEFAULT_REFRESH_MS 1000
+
+typedef struct TopView {
+    ProcessInformation entries[TOP_MAX_ENTRIES];
+    int count;
+    uint64_t generation;    // 0 asks the kernel for the whole table
+} TopView;
+
+static void removeEntry(TopView * view, int pid) {
+    for (int i = 0; i < view->count; i++) {
+        if (view->entries[i].pid == pid) {
+            view->entries[i] = view->entries[--view->count];
+            return;
+        }
+    }
+}
+
+static void storeEntry(TopView * view, ProcessInformation * info) {
+    for (int i = 0; i < view->count; i++) {
+        if (view->entries[i].pid == info->pid) {
+            view->entries[i] = *info;
+            return;
+        }
+    }
+    if (view->count < TOP_MAX_ENTRIES) {
+        view->entries[view->count++] = *info;
+    }
+}
+
+// Folds a delta into the view, returns how many entries the kernel sent or -1
+static int refreshView(TopView * view, ProcessInformation * changed) {
+    ProcessSnapshot snapshot;
+    int count = processSnapshot(view->generation, changed, TOP_MAX_ENTRIES, &snapshot);
+    if (count < 0) {
+        return -1;
+    }
+
+    if (snapshot.full) {
+        view->count = 0;
+    }
+    for (int i = 0; i < snapshot.removedCount; i++) {
+        removeEntry(view, snapshot.removed[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        storeEntry(view, &changed[i]);
+    }
+    // A table that did not fit leaves changes behind, start over from a full copy
+    view->generation = (count == TOP_MAX_ENTRIES) ? 0 : snapshot.generation;
+    return count;
+}
+
+static const char * stateName(ProcessState state) {
+    switch (state) {
+        case PROCESS_STATE_READY:      return "READY";
+        case PROCESS_STATE_RUNNING:    return "RUNNING";
+        case PROCESS_STATE_BLOCKED:    return "BLOCKED";
+        case PROCESS_STATE_TERMINATED: return "TERMINATED";
+        default:                       return "UNKNOWN";
+    }
+}
+
+int _top(int argc, char * argv[]) {
+    int refresh = TOP_DEFAULT_REFRESH_MS;
+    int iterations = 0;
+
+    if (argc > 3 || (argc > 1 && (sscanf(argv[1], "%d", &refresh) != 1 || refresh <= 0))
+        || (argc > 2 && (sscanf(argv[2], "%d", &iterations) != 1 || iterations < 0))) {
+        perror("Usage: top [refresh_ms] [iterations]\n");
+        return 1;
+    }
+
+    TopView * view = myMalloc(sizeof(TopView));
+    ProcessInformation * changed = myMalloc(sizeof(ProcessInformation) * TOP_MAX_ENTRIES);
+    if (view == NULL || changed == NULL) {
+        perror("top: not enough memory\n");
+        myFree(view);
+        myFree(changed);
+        return 1;
+    }
+    view->count = 0;
+    view->generation = 0;
+
+    // Runs until Ctrl+C when no iteration count is given
+    for (int i = 0; iterations == 0 || i < iterations; i++) {
+        int sent = refreshView(view, changed);
+        if (sent < 0) {
+            perror("top: syscall failed\n");
+            myFree(view);
+            myFree(changed);
+            return 1;
+        }
+
+        clearScreen();
+        printf("\e[0;36mtop\e[0m  every %d ms  processes: %d  updated: %d\n\n", refresh, view->count, sent);
+        printf("PID\tState\t\tPrio\tStack\t\tName\n");
+        for (int j = 0; j < view->count; j++) {
+            ProcessInformation * info = &view->entries[j];
+            printf("%d\t%s\t%s%d\t%d/%d\t%s\n", info->pid, stateName(info->state),
+                   (int)strlen(stateName(info->state)) < 8 ? "\t" : "", info->priority,
+                   info->stack_used, info->stack_size, info->name[0] ? info->name : "<unnamed>");
+        }
+        sleep(refresh);
+    }
+
+    myFree(view);
+    myFree(changed);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "commands.h"
+
+static char * resourceNames[RESOURCE_COUNT] = {
+    [RESOURCE_HEAP]       = "heap",
+    [RESOURCE_STACK]      = "stack",
+    [RESOURCE_PIPES]      = "pipes",
+    [RESOURCE_SEMAPHORES] = "sems",
+};
+
+static int findResource(char * name) {
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        if (strcmp(resourceNames[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int printResources(int pid) {
+    ResourceUsage resources;
+    if (getResourceUsage(pid, &resources) != 0) {
+        fprintf(FD_STDERR, "ulimit: no process with pid %d\n", pid);
+        return 1;
+    }
+
+    printf("Resource\tUsage\t\tLimit\n");
+    for (int i = 0; i < RESOURCE_COUNT; i++) {
+        if (resources.limits[i] == RESOURCE_UNLIMITED) {
+            printf("%s\t\t%d\t\tunlimited\n", resourceNames[i], resources.usage[i]);
+        } else {
+            printf("%s\t\t%d\t\t%d\n", resourceNames[i], resources.usage[i], resources.limits[i]);
+        }
+    }
+    return 0;
+}
+
+int _ulimit(int argc, char * argv[]) {
+    int pid = 0;
+    if ((argc != 2 && argc != 4) || sscanf(argv[1], "%d", &pid) != 1) {
+        perror("Usage: ulimit <pid> [heap|stack|pipes|sems <limit|-1>]\n");
+        return 1;
+    }
+
+    if (argc == 2) {
+        return printResources(pid);
+    }
+
+    int type = findResource(argv[2]);
+    int limit = 0;
+    if (type < 0) {
+        fprintf(FD_STDERR, "ulimit: unknown resource '%s'\n", argv[2]);
+        return 1;
+    }
+    if (sscanf(argv[3], "%d", &limit) != 1 || limit < RESOURCE_UNLIMITED) {
+        fprintf(FD_STDERR, "ulimit: invalid limit '%s'\n", argv[3]);
+        return 1;
+    }
+
+    // Children created afterwards inherit the limit, so limiting the shell caps every command it runs
+    if (setResourceLimit(pid, (ResourceType)type, limit) != 0) {
+        fprintf(FD_STDERR, "ulimit: unable to change the limits of pid %d\n", pid);
+        return 1;
+    }
+    return printResources(pid);
+}
@@ -72,21 +72,31 @@ Command commands[] = {
 	{.name = "history", .function = history, .description = "Prints the command history", .is_builtin = 1},
 	{.name = "invop", .function = _exception_invop, .description = "Generates an invalid opcode exception", .is_builtin = 0},
 	{.name = "kill", .function = _shell_kill, .description = "Terminates the provided PID", .is_builtin = 0},
+	{.name = "lockstat", .function = _lockstat, .description = "Lock contention sorted by wait time (LOCK_STATS=1 builds): lockstat [rows]", .is_builtin = 0},
 	{.name = "loop", .function = _loop, .description = "Prints a message every specified ms", .is_builtin = 0},
 	{.name = "man", .function = _man, .description = "Shows the manual for a command", .is_builtin = 0},
-	{.name = "mem", .function = _mem_stats, .description = "Displays memory statistics", .is_builtin = 0},
+	{.name = "mem", .function = _mem_stats, .description = "Displays memory statistics: mem [pid]", .is_builtin = 0},
     {.name = "mvar", .function = _mvar, .description = "Creates a multi-variable process", .is_builtin = 0},
     {.name = "mvar-kill", .function = _mvar_close, .description = "Kills mvar processes (Ctrl+K)", .is_builtin = 0},
 	{.name = "nice", .function = _nice, .description = "Changes a process priority: nice <pid> <priority>", .is_builtin = 0},
 	{.name = "ps", .function = _ps, .description = "Lists active processes", .is_builtin = 0},
 	{.name = "regs", .function = _regs, .description = "Prints the last register snapshot", .is_builtin = 0},
 	{.name = "snake", .function = _snake, .description = "Launches the snake game", .is_builtin = 0},
+	{.name = "test_barrier", .function = _test_barrier, .description = "Workers stepping through phases in lockstep: test_barrier [worker_count]", .is_builtin = 0},
+	{.name = "test_cond", .function = _test_cond, .description = "Consumers sharing a mutex and condition variable: test_cond [consumer_count]", .is_builtin = 0},
 	{.name = "test_mm", .function = _test_mm, .description = "Stress tests the memory manager: test_mm <max_memory>", .is_builtin = 0},
+	{.name = "test_pipe", .function = _test_pipe, .description = "Pipeline throughput in MB/s: test_pipe [kilobytes] [stages]", .is_builtin = 0},
 	{.name = "test_prio", .function = _test_prio, .description = "Spawns processes with different priorities: test_prio <max_value>", .is_builtin = 0},
 	{.name = "test_processes", .function = _test_processes, .description = "Creates and kills processes randomly: test_processes <max_processes>", .is_builtin = 0},
-	{.name = "test_sync", .function = _test_sync, .description = "Synchronization race test: test_sync <iterations> <use_semaphore:0|1>", .is_builtin = 0},
+	{.name = "test_rwlock", .function = _test_rwlock, .description = "Read-heavy throughput of rwlock vs mutex: test_rwlock [max_readers]", .is_builtin = 0},
+	{.name = "test_sem", .function = _test_sem, .description = "Measures semaphore round trips and uncontended ops/s: test_sem [rounds]", .is_builtin = 0},
+	{.name = "test_spawn", .function = _test_spawn, .description = "Compares single and batched process creation: test_spawn [process_count]", .is_builtin = 0},
+	{.name = "test_sync", .function = _test_sync, .description = "Synchronization race test: test_sync <iterations> <use_semaphore:0|1|2|3>", .is_builtin = 0},
+	{.name = "test_threads", .function = _test_threads, .description = "Compares thread and process creation cost: test_threads [worker_count]", .is_builtin = 0},
 	{.name = "test_wait_children", .function = _test_wait_children, .description = "Spawns children and waits for all: test_wait_children [child_count]", .is_builtin = 0},
 	{.name = "time", .function = _time, .description = "Displays the current time", .is_builtin = 0},
+	{.name = "top", .function = _top, .description = "Refreshes the process list in place: top [refresh_ms] [iterations]", .is_builtin = 0},
+	{.name = "ulimit", .function = _ulimit, .description = "Shows or caps a process resources: ulimit <pid> [heap|stack|pipes|sems <limit|-1>]", .is_builtin = 0},
 	{.name = "wc", .function = _wc, .description = "Counts stdin lines", .is_builtin = 0},
 };
 
@@ -429,27 +439,17 @@ static int run_pipeline(CommandInvocation *calls, int count, int pipeline_backgr
 			next_pipe = pipefd[READ_FD];
 		}
 
-		int input_type = (pending_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE;
-		int input_target = (pending_pipe >= 0) ? pending_pipe : -1;
-		if (setFdTarget(READ_FD, input_type, input_target) != 0) {
-			fprintf(FD_STDERR, "shell: unable to configure stdin\n");
-			setFdTarget(READ_FD, PIPE_ENDPOINT_CONSOLE, -1);
-			return -1;
-		}
-
-		int output_type = (next_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE;
-		int output_target = (next_pipe >= 0) ? next_pipe : -1;
-		if (setFdTarget(WRITE_FD, output_type, output_target) != 0) {
-			fprintf(FD_STDERR, "shell: unable to configure stdout\n");
-			setFdTarget(READ_FD, PIPE_ENDPOINT_CONSOLE, -1);
-			setFdTarget(WRITE_FD, PIPE_ENDPOINT_CONSOLE, -1);
-			return -1;
-		}
-
-		uint8_t run_in_background = pipeline_background ? 1 : (is_last ? 0 : 1);
-		int32_t pid = createProcess((void *)current->command->function, current->argc, (uint8_t **)current->argv, run_in_background);
-		setFdTarget(READ_FD, PIPE_ENDPOINT_CONSOLE, -1);
-		setFdTarget(WRITE_FD, PIPE_ENDPOINT_CONSOLE, -1);
+		// The stage gets its endpoints at creation, the shell's own fds never leave the console
+		SpawnAttributes attributes = {
+			.actions = {
+				{.fd = READ_FD, .type = (pending_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE, .pipeID = pending_pipe},
+				{.fd = WRITE_FD, .type = (next_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE, .pipeID = next_pipe},
+			},
+			.actionCount = 2,
+			.priority = SPAWN_INHERIT_PRIORITY,
+			.is_background = pipeline_background ? 1 : (is_last ? 0 : 1),
+		};
+		int32_t pid = spawnProcess((void *)current->command->function, current->argc, current->argv, &attributes);
 
 		if (pid < 0) {
 			fprintf(FD_STDERR, "shell: unable to create process for '%s'\n", current->command->name);
@@ -0,0 +1,134 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+
+#define DEFAULT_WORKERS 4
+#define MAX_WORKERS 32
+#define PHASES 50
+#define RACE_ROUNDS 10
+#define RACE_SETTLE_MS 50
+
+static void *barrier;
+static void *finished;
+static volatile int progress[MAX_WORKERS];
+static volatile int out_of_step;
+static volatile int serial_returns;
+static volatile int workers;
+static void *race_barrier;
+static void *race_latch;
+static volatile int destroy_failures;
+
+// Each phase bumps the worker's own counter, after the barrier every counter must have reached the phase
+static uint64_t worker_process(uint64_t argc, char *argv[]) {
+  int id = satoi(argv[0]);
+  for (int phase = 1; phase <= PHASES; phase++) {
+    progress[id] = phase;
+    if (barrierWait(barrier) == 1)
+      serial_returns++;
+    for (int i = 0; i < workers; i++)
+      if (progress[i] < phase)
+        out_of_step++;
+    // Nobody may start the next phase before everyone checked this one
+    barrierWait(barrier);
+  }
+  latchCountDown(finished, 1);
+  return 0;
+}
+
+// Whoever releases the others frees the object at once, before the woken waiters get to run
+static uint64_t race_process(uint64_t argc, char *argv[]) {
+  latchWait(race_latch);
+  if (barrierWait(race_barrier) == 1 && barrierDestroy(race_barrier) != 0)
+    destroy_failures++;
+  return 0;
+}
+
+static int destroy_race(int32_t pids[]) {
+  destroy_failures = 0;
+  for (int round = 0; round < RACE_ROUNDS; round++) {
+    race_barrier = barrierCreate(workers);
+    race_latch = latchCreate(1);
+    if (race_barrier == NULL || race_latch == NULL) {
+      printf("test_barrier: ERROR creating barrier or latch\n");
+      return -1;
+    }
+    for (int i = 0; i < workers; i++) {
+      pids[i] = createProcess((void *)race_process, 0, NULL, 0);
+      if (pids[i] < 0) {
+        printf("test_barrier: ERROR creating worker\n");
+        return -1;
+      }
+    }
+    // Lets every worker queue on the latch first
+    sleep(RACE_SETTLE_MS);
+    latchCountDown(race_latch, 1);
+    if (latchDestroy(race_latch) != 0)
+      destroy_failures++;
+    for (int i = 0; i < workers; i++)
+      waitPid(pids[i]);
+  }
+  if (destroy_failures > 0) {
+    printf("test_barrier: %d destroys failed right after the last wait returned\n", destroy_failures);
+    return -1;
+  }
+  return 0;
+}
+
+int64_t test_barrier(uint64_t argc, char *argv[]) {
+  workers = DEFAULT_WORKERS;
+  if (argc > 1 && ((workers = satoi(argv[1])) <= 0 || workers > MAX_WORKERS)) {
+    printf("test_barrier: worker count must be between 1 and %d\n", MAX_WORKERS);
+    return -1;
+  }
+
+  barrier = barrierCreate(workers);
+  finished = latchCreate(workers);
+  if (barrier == NULL || finished == NULL) {
+    printf("test_barrier: ERROR creating barrier or latch\n");
+    return -1;
+  }
+  out_of_step = 0;
+  serial_returns = 0;
+
+  int32_t pids[MAX_WORKERS];
+  char ids[MAX_WORKERS][4];
+  uint64_t start = read_cycles();
+  for (int i = 0; i < workers; i++) {
+    progress[i] = 0;
+    ids[i][0] = '0' + i / 10;
+    ids[i][1] = '0' + i % 10;
+    ids[i][2] = '\0';
+    char *args[] = {ids[i], NULL};
+    pids[i] = createProcess((void *)worker_process, 1, (uint8_t **)args, 0);
+    if (pids[i] < 0) {
+      printf("test_barrier: ERROR creating worker\n");
+      return -1;
+    }
+  }
+
+  // One wait for the whole group instead of a waitPid per worker
+  latchWait(finished);
+  uint64_t cycles = read_cycles() - start;
+  for (int i = 0; i < workers; i++)
+    waitPid(pids[i]);
+
+  printf("%d workers, %d phases: %d cycles per barrier round\n", workers, PHASES,
+         (int)(cycles / (2 * PHASES)));
+  int failed = 0;
+  if (out_of_step > 0) {
+    printf("test_barrier: %d workers ran ahead of the barrier\n", out_of_step);
+    failed = 1;
+  }
+  if (serial_returns != PHASES) {
+    printf("test_barrier: %d rounds completed, expected %d\n", serial_returns, PHASES);
+    failed = 1;
+  }
+  if (barrierDestroy(barrier) != 0 || latchDestroy(finished) != 0) {
+    printf("test_barrier: barrier or latch still in use after every worker ended\n");
+    failed = 1;
+  }
+  if (destroy_race(pids) != 0)
+    failed = 1;
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+
+#define DEFAULT_CONSUMERS 4
+#define MAX_CONSUMERS 16
+#define ITEMS_PER_CONSUMER 200
+
+// Shared by every consumer, only touched while owning mutex
+static void *mutex;
+static void *not_empty;
+static volatile int available;
+static volatile int consumed;
+static volatile int done;
+
+static uint64_t consumer_process(uint64_t argc, char *argv[]) {
+  mutexLock(mutex);
+  while (1) {
+    while (available == 0 && !done)
+      condWait(not_empty, mutex);
+    if (available == 0)
+      break;
+    available--;
+    consumed++;
+  }
+  mutexUnlock(mutex);
+  return 0;
+}
+
+int64_t test_cond(uint64_t argc, char *argv[]) {
+  int consumers = DEFAULT_CONSUMERS;
+  if (argc > 1 && ((consumers = satoi(argv[1])) <= 0 || consumers > MAX_CONSUMERS)) {
+    printf("test_cond: consumer count must be between 1 and %d\n", MAX_CONSUMERS);
+    return -1;
+  }
+
+  mutex = mutexCreate(0);
+  not_empty = condCreate();
+  if (mutex == NULL || not_empty == NULL) {
+    printf("test_cond: ERROR creating mutex or condition\n");
+    return -1;
+  }
+  available = 0;
+  consumed = 0;
+  done = 0;
+
+  int32_t pids[MAX_CONSUMERS];
+  char *args[] = {"consumer", NULL};
+  for (int i = 0; i < consumers; i++) {
+    pids[i] = createProcess((void *)consumer_process, 1, (uint8_t **)args, 0);
+    if (pids[i] < 0) {
+      printf("test_cond: ERROR creating consumer\n");
+      return -1;
+    }
+  }
+
+  int items = consumers * ITEMS_PER_CONSUMER;
+  for (int i = 0; i < items; i++) {
+    mutexLock(mutex);
+    available++;
+    condSignal(not_empty);
+    mutexUnlock(mutex);
+    if (i % consumers == 0)
+      yield();
+  }
+
+  // The broadcast moves every sleeping consumer to the mutex, they leave one at a time
+  mutexLock(mutex);
+  done = 1;
+  condBroadcast(not_empty);
+  mutexUnlock(mutex);
+
+  for (int i = 0; i < consumers; i++)
+    waitPid(pids[i]);
+
+  printf("produced %d, consumed %d\n", items, consumed);
+  int failed = consumed != items;
+  if (mutexDestroy(mutex) != 0 || condDestroy(not_empty) != 0) {
+    printf("test_cond: mutex or condition still in use after every consumer ended\n");
+    failed = 1;
+  }
+  return failed ? -1 : 0;
+}
@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "syscalls.h"
+#include "test_util.h"
+
+#define DEFAULT_KILOBYTES 256
+#define DEFAULT_STAGES 2
+#define MAX_STAGES 8
+#define CHUNK_SIZE 2048
+#define STAGE_STACK_SIZE 8192     // Room for a CHUNK_SIZE buffer on the stack of each stage
+
+// Every stage of a run moves the same amount, the consumer reports what reached the end
+static volatile int total_bytes;
+static volatile int chunk_size;
+static volatile int received;
+static volatile int zero_copy;    // Producer lends its buffer and forwarders splice instead of read/write
+
+static uint64_t producer_process(uint64_t argc, char *argv[]) {
+  static char data[CHUNK_SIZE];
+  for (int i = 0; i < CHUNK_SIZE; i++)
+    data[i] = 'a' + i % 26;
+
+  int sent = 0;
+  while (sent < total_bytes) {
+    int size = (total_bytes - sent < chunk_size) ? total_bytes - sent : chunk_size;
+    int written = zero_copy ? vmsplice(FD_STDOUT, data, size) : sys_write(FD_STDOUT, data, size);
+    if (written <= 0)
+      break;
+    sent += written;
+  }
+  return 0;
+}
+
+// Like cat, copies stdin to stdout until the upstream end closes
+static uint64_t forward_process(uint64_t argc, char *argv[]) {
+  if (zero_copy) {
+    while (splice(FD_STDIN, FD_STDOUT, chunk_size) > 0)
+      ;
+    return 0;
+  }
+
+  char buffer[CHUNK_SIZE];
+  int count;
+  while ((count = sys_read(FD_STDIN, buffer, chunk_size)) > 0) {
+    if (sys_write(FD_STDOUT, buffer, count) != count)
+      break;
+  }
+  return 0;
+}
+
+// Like wc, only counts what arrives
+static uint64_t consumer_process(uint64_t argc, char *argv[]) {
+  char buffer[CHUNK_SIZE];
+  int count;
+  int bytes = 0;
+  while ((count = sys_read(FD_STDIN, buffer, chunk_size)) > 0)
+    bytes += count;
+  received = bytes;
+  return 0;
+}
+
+static int32_t spawn_stage(void *function, int read_pipe, int write_pipe) {
+  char *args[] = {"pipe_bench", NULL};
+  SpawnAttributes attributes = {
+    .actions = {
+      {.fd = READ_FD, .type = (read_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE, .pipeID = read_pipe},
+      {.fd = WRITE_FD, .type = (write_pipe >= 0) ? PIPE_ENDPOINT_PIPE : PIPE_ENDPOINT_CONSOLE, .pipeID = write_pipe},
+    },
+    .actionCount = 2,
+    .priority = SPAWN_INHERIT_PRIORITY,
+    .is_background = 1,
+    .stackSize = STAGE_STACK_SIZE,
+  };
+  return spawnProcess(function, 1, args, &attributes);
+}
+
+// Cycles to push total_bytes through producer, forwarders and consumer, 0 on failure
+static uint64_t run_chain(int stages) {
+  int32_t pids[MAX_STAGES];
+  int pending_pipe = -1;
+  received = 0;
+
+  uint64_t start = read_cycles();
+  for (int i = 0; i < stages; i++) {
+    int pipefd[PIPE_FD_COUNT] = {-1, -1};
+    int is_last = (i == stages - 1);
+    if (!is_last && openPipe(pipefd) != 0)
+      return 0;
+    void *function = (i == 0) ? (void *)producer_process : is_last ? (void *)consumer_process : (void *)forward_process;
+    pids[i] = spawn_stage(function, pending_pipe, is_last ? -1 : pipefd[READ_FD]);
+    if (pids[i] < 0)
+      return 0;
+    pending_pipe = pipefd[READ_FD];
+  }
+  for (int i = 0; i < stages; i++)
+    waitPid(pids[i]);
+  return read_cycles() - start;
+}
+
+int64_t test_pipe(uint64_t argc, char *argv[]) {
+  int kilobytes = DEFAULT_KILOBYTES;
+  int stages = DEFAULT_STAGES;
+  if (argc > 1 && (kilobytes = satoi(argv[1])) <= 0) {
+    printf("test_pipe: invalid size '%s'\n", argv[1]);
+    return -1;
+  }
+  if (argc > 2 && ((stages = satoi(argv[2])) < 2 || stages > MAX_STAGES)) {
+    printf("test_pipe: stage count must be between 2 and %d\n", MAX_STAGES);
+    return -1;
+  }
+  total_bytes = kilobytes * 1024;
+
+  uint64_t cycles_per_second = measure_cycles_per_second();
+
+  // Byte at a time is what getchar/putchar pipelines do, the chunked run moves CHUNK_SIZE per syscall and
+  // the zero-copy run moves the same chunks with vmsplice/splice, one copy per stage instead of two
+  int sizes[] = {1, CHUNK_SIZE, CHUNK_SIZE};
+  char *modes[] = {"byte writes", "byte writes", "byte splices"};
+  int failed = 0;
+  printf("%d KB through %d stages\n", kilobytes, stages);
+  for (int i = 0; i < 3 && !failed; i++) {
+    chunk_size = sizes[i];
+    zero_copy = (i == 2);
+    uint64_t cycles = run_chain(stages);
+    if (cycles == 0) {
+      printf("test_pipe: ERROR building the pipeline\n");
+      failed = 1;
+    } else if (received != total_bytes) {
+      printf("test_pipe: %d of %d bytes arrived\n", received, total_bytes);
+      failed = 1;
+    } else {
+      printf("%d %s: %d KB/s (%d MB/s)\n", chunk_size, modes[i], (int)((uint64_t)kilobytes * cycles_per_second / cycles),
+             (int)((uint64_t)kilobytes * cycles_per_second / cycles / 1024));
+    }
+  }
+  return failed ? -1 : 0;
+}
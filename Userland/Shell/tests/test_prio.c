@@ -34,8 +34,15 @@ uint64_t test_prio(uint64_t argc, char *argv[]) {
 
   printf("SAME PRIORITY...\n");
 
+  // Spawned in one batch so they all become ready at the same time
+  SpawnRequest requests[TOTAL_PROCESSES];
+  int32_t batch_pids[TOTAL_PROCESSES];
   for (i = 0; i < TOTAL_PROCESSES; i++)
-    pids[i] = createProcess((void *)zero_to_max, 0, (uint8_t**)ztm_argv, 0);
+    requests[i] = (SpawnRequest){.function = (void *)zero_to_max, .argv = ztm_argv, .attributes = {.priority = SPAWN_INHERIT_PRIORITY}};
+  if (spawnBatch(requests, TOTAL_PROCESSES, batch_pids) != TOTAL_PROCESSES)
+    return -1;
+  for (i = 0; i < TOTAL_PROCESSES; i++)
+    pids[i] = batch_pids[i];
 
   // Expect to see them finish at the same time
 
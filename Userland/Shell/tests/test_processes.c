@@ -12,8 +12,8 @@ typedef struct P_rq {
 } p_rq;
 
 int64_t test_processes(uint64_t argc, char *argv[]) {
-  uint8_t rq;
-  uint8_t alive = 0;
+  uint64_t rq;
+  uint64_t alive = 0;
   uint8_t action;
   uint64_t max_processes;
   uint8_t *argvAux[] = {(uint8_t *)"endless_loop", 0};
@@ -24,7 +24,12 @@ int64_t test_processes(uint64_t argc, char *argv[]) {
   if ((max_processes = satoi(argv[1])) <= 0)
     return -1;
 
-  p_rq p_rqs[max_processes];
+  // Kept on the heap: a few thousand entries would not fit in the process stack
+  p_rq *p_rqs = myMalloc(sizeof(p_rq) * max_processes);
+  if (p_rqs == NULL) {
+    printf("test_processes: ERROR allocating request table\n");
+    return -1;
+  }
   
 
   while (1) {
@@ -34,6 +39,7 @@ int64_t test_processes(uint64_t argc, char *argv[]) {
 
       if (p_rqs[rq].pid == -1) {
         printf("test_processes: ERROR creating process\n");
+        myFree(p_rqs);
         return -1;
       } else {
         //printf("test_processes: created process %d\n", p_rqs[rq].pid); //Debug line
@@ -53,6 +59,7 @@ int64_t test_processes(uint64_t argc, char *argv[]) {
             if (p_rqs[rq].state == RUNNING || p_rqs[rq].state == BLOCKED) {
               if (kill(p_rqs[rq].pid) == -1) {
                 printf("test_processes: ERROR killing process\n");
+                myFree(p_rqs);
                 return -1;
               }
               //printf("test_processes: killed process %d\n", p_rqs[rq].pid); //Debug line
@@ -65,6 +72,7 @@ int64_t test_processes(uint64_t argc, char *argv[]) {
             if (p_rqs[rq].state == RUNNING) {
               if (block(p_rqs[rq].pid) == -1) {
                 printf("test_processes: ERROR blocking process\n");
+                myFree(p_rqs);
                 return -1;
               }
               //printf("test_processes: blocked process %d\n", p_rqs[rq].pid); //Debug line
@@ -79,6 +87,7 @@ int64_t test_processes(uint64_t argc, char *argv[]) {
         if (p_rqs[rq].state == BLOCKED && GetUniform(100) % 2) {
           if (unblock(p_rqs[rq].pid) == -1) {
             printf("test_processes: ERROR unblocking process\n");
+            myFree(p_rqs);
             return -1;
           }
           p_rqs[rq].state = RUNNING;
@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+
+#define DEFAULT_MAX_READERS 8
+#define MAX_READERS 32
+#define READS_PER_READER 200
+#define WRITES 20
+
+// Shared state the writer changes in two steps, a reader seeing the halves differ raced with it
+static volatile int64_t first_half;
+static volatile int64_t second_half;
+static volatile int torn_reads;
+static volatile int use_rwlock;
+static void *rwlock;
+static void *mutex;
+static void *start_gate;      // Holds every process back until all of them exist
+
+static void read_lock(void) {
+  if (use_rwlock)
+    rwlockReadLock(rwlock);
+  else
+    mutexLock(mutex);
+}
+
+static void write_lock(void) {
+  if (use_rwlock)
+    rwlockWriteLock(rwlock);
+  else
+    mutexLock(mutex);
+}
+
+static void release(void) {
+  if (use_rwlock)
+    rwlockUnlock(rwlock);
+  else
+    mutexUnlock(mutex);
+}
+
+// Yields inside the section, so readers that exclude each other pay a switch per read
+static uint64_t reader_process(uint64_t argc, char *argv[]) {
+  latchWait(start_gate);
+  for (int i = 0; i < READS_PER_READER; i++) {
+    read_lock();
+    int64_t first = first_half;
+    yield();
+    if (first != second_half)
+      torn_reads++;
+    release();
+  }
+  return 0;
+}
+
+static uint64_t writer_process(uint64_t argc, char *argv[]) {
+  latchWait(start_gate);
+  for (int i = 0; i < WRITES; i++) {
+    write_lock();
+    first_half++;
+    yield();
+    second_half++;
+    release();
+    yield();
+  }
+  return 0;
+}
+
+// Cycles from releasing the readers and the writer together until all of them are done, 0 on failure
+static uint64_t run(int readers) {
+  int32_t pids[MAX_READERS + 1];
+  char *args[] = {"rw_bench", NULL};
+
+  start_gate = latchCreate(1);
+  if (start_gate == NULL)
+    return 0;
+  pids[0] = createProcess((void *)writer_process, 1, (uint8_t **)args, 0);
+  for (int i = 1; i <= readers; i++)
+    pids[i] = createProcess((void *)reader_process, 1, (uint8_t **)args, 0);
+
+  uint64_t start = read_cycles();
+  latchCountDown(start_gate, 1);
+  int failed = 0;
+  for (int i = 0; i <= readers; i++) {
+    if (pids[i] < 0)
+      failed = 1;
+    else
+      waitPid(pids[i]);
+  }
+  uint64_t cycles = read_cycles() - start;
+  latchDestroy(start_gate);
+  return failed ? 0 : cycles;
+}
+
+int64_t test_rwlock(uint64_t argc, char *argv[]) {
+  int max_readers = DEFAULT_MAX_READERS;
+  if (argc > 1 && ((max_readers = satoi(argv[1])) <= 0 || max_readers > MAX_READERS)) {
+    printf("test_rwlock: reader count must be between 1 and %d\n", MAX_READERS);
+    return -1;
+  }
+
+  rwlock = rwlockCreate();
+  mutex = mutexCreate(0);
+  if (rwlock == NULL || mutex == NULL) {
+    printf("test_rwlock: ERROR creating locks\n");
+    return -1;
+  }
+
+  uint64_t cycles_per_second = measure_cycles_per_second();
+
+  first_half = second_half = 0;
+  torn_reads = 0;
+  int failed = 0;
+  printf("Readers\tmutex reads/s\trwlock reads/s\n");
+  for (int readers = 1; readers <= max_readers && !failed; readers *= 2) {
+    uint64_t reads = (uint64_t)readers * READS_PER_READER;
+
+    use_rwlock = 0;
+    uint64_t mutex_cycles = run(readers);
+    use_rwlock = 1;
+    uint64_t rwlock_cycles = run(readers);
+    if (mutex_cycles == 0 || rwlock_cycles == 0) {
+      printf("test_rwlock: ERROR creating processes\n");
+      failed = 1;
+      break;
+    }
+    printf("%d\t%d\t\t%d\n", readers, (int)(reads * cycles_per_second / mutex_cycles),
+           (int)(reads * cycles_per_second / rwlock_cycles));
+  }
+
+  if (torn_reads > 0) {
+    printf("test_rwlock: %d reads overlapped a write\n", torn_reads);
+    failed = 1;
+  }
+  if (rwlockDestroy(rwlock) != 0 || mutexDestroy(mutex) != 0) {
+    printf("test_rwlock: lock still in use after every process ended\n");
+    failed = 1;
+  }
+  return failed ? -1 : 0;
+}
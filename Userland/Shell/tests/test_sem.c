@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+#include "fastSemaphore.h"
+
+#define DEFAULT_ROUNDS 2000
+#define UNCONTENDED_FACTOR 16     // Uncontended pairs are cheap, run more of them
+#define PING_SEM "bench_ping"
+#define PONG_SEM "bench_pong"
+#define SOLO_SEM "bench_solo"
+
+static void *ping;
+static void *pong;
+static volatile int rounds;
+
+// Every wait finds the semaphore at zero, so each round blocks and wakes both sides once
+static uint64_t pong_process(uint64_t argc, char *argv[]) {
+  for (int i = 0; i < rounds; i++) {
+    semWait(ping);
+    semPost(pong);
+  }
+  return 0;
+}
+
+// Operations per second from the cycles spent, using a TSC rate measured against the timer
+static int ops_per_second(uint64_t cycles, int ops, uint64_t cycles_per_second) {
+  if (cycles == 0)
+    return 0;
+  return (int)((uint64_t)ops * cycles_per_second / cycles);
+}
+
+// Wait/post pairs that never block: each one is two syscalls on a kernel semaphore, two atomics on a fast one
+static int uncontended(int pairs) {
+  void *solo = semInit(SOLO_SEM, 1);
+  if (solo == NULL) {
+    printf("test_sem: ERROR opening semaphore\n");
+    return -1;
+  }
+  FastSemaphore fast;
+  fastSemInit(&fast, 1);
+
+  uint64_t cycles_per_second = measure_cycles_per_second();
+
+  uint64_t start = read_cycles();
+  for (int i = 0; i < pairs; i++) {
+    semWait(solo);
+    semPost(solo);
+  }
+  uint64_t syscall_cycles = read_cycles() - start;
+
+  start = read_cycles();
+  for (int i = 0; i < pairs; i++) {
+    fastSemWait(&fast);
+    fastSemPost(&fast);
+  }
+  uint64_t fast_cycles = read_cycles() - start;
+  semDestroy(solo);
+
+  printf("%d uncontended wait/post pairs\n", pairs);
+  printf("syscall: %d cycles per op, ~%d ops/s\n", (int)(syscall_cycles / (2 * pairs)),
+         ops_per_second(syscall_cycles, 2 * pairs, cycles_per_second));
+  printf("fast:    %d cycles per op, ~%d ops/s\n", (int)(fast_cycles / (2 * pairs)),
+         ops_per_second(fast_cycles, 2 * pairs, cycles_per_second));
+  return 0;
+}
+
+int64_t test_sem(uint64_t argc, char *argv[]) {
+  rounds = DEFAULT_ROUNDS;
+  if (argc > 1 && (rounds = satoi(argv[1])) <= 0) {
+    printf("test_sem: invalid round count '%s'\n", argv[1]);
+    return -1;
+  }
+
+  ping = semInit(PING_SEM, 0);
+  pong = semInit(PONG_SEM, 0);
+  if (ping == NULL || pong == NULL) {
+    printf("test_sem: ERROR opening semaphores\n");
+    if (ping != NULL)
+      semDestroy(ping);
+    if (pong != NULL)
+      semDestroy(pong);
+    return -1;
+  }
+
+  char *argvPong[] = {"sem_pong", NULL};
+  int pid = createProcess((void *)pong_process, 1, (uint8_t **)argvPong, 1);
+  if (pid < 0) {
+    printf("test_sem: ERROR creating the partner process\n");
+    semDestroy(ping);
+    semDestroy(pong);
+    return -1;
+  }
+
+  MemoryStats before, after;
+  memExtended(&before);
+  uint64_t start = read_cycles();
+  for (int i = 0; i < rounds; i++) {
+    semPost(ping);
+    semWait(pong);
+  }
+  uint64_t cycles = read_cycles() - start;
+  memExtended(&after);
+
+  waitPid(pid);
+  semDestroy(ping);
+  semDestroy(pong);
+
+  // Only other processes running at the same time can allocate during the loop
+  uint32_t allocations = (after.allocationCount + after.failedCount) - (before.allocationCount + before.failedCount);
+  printf("%d contended post/wait round trips\n", rounds);
+  printf("%d cycles per round trip\n", (int)(cycles / rounds));
+  printf("heap allocations during the run: %d\n", allocations);
+  return uncontended(rounds * UNCONTENDED_FACTOR);
+}
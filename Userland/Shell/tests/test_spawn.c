@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+
+#define DEFAULT_ROUNDS 16
+
+// Children wait for the round to end so both modes create the same number of live processes
+static volatile int release_children = 0;
+
+static uint64_t idle_child(uint64_t argc, char *argv[]) {
+  while (!release_children)
+    yield();
+  return 0;
+}
+
+static int reap(int32_t *pids, int count) {
+  release_children = 1;
+  int status = 0;
+  for (int i = 0; i < count; i++) {
+    if (pids[i] >= 0 && waitPid(pids[i]) != 0)
+      status = -1;
+  }
+  release_children = 0;
+  return status;
+}
+
+static uint64_t spawn_single(SpawnRequest *requests, int32_t *pids, int count) {
+  uint64_t start = read_cycles();
+  for (int i = 0; i < count; i++)
+    pids[i] = spawnProcess(requests[i].function, requests[i].argc, requests[i].argv, &requests[i].attributes);
+  return read_cycles() - start;
+}
+
+static uint64_t spawn_batch(SpawnRequest *requests, int32_t *pids, int count) {
+  uint64_t start = read_cycles();
+  spawnBatch(requests, count, pids);
+  return read_cycles() - start;
+}
+
+// Spawns per second from the cycles spent, using a TSC rate measured against the timer
+static int spawns_per_second(uint64_t cycles, int spawns, uint64_t cycles_per_second) {
+  if (cycles == 0)
+    return 0;
+  return (int)((uint64_t)spawns * cycles_per_second / cycles);
+}
+
+int64_t test_spawn(uint64_t argc, char *argv[]) {
+  int rounds = DEFAULT_ROUNDS;
+  int count = SPAWN_BATCH_MAX / 2;
+  if (argc > 1 && (count = satoi(argv[1])) <= 0) {
+    printf("test_spawn: invalid process count '%s'\n", argv[1]);
+    return -1;
+  }
+  if (count > SPAWN_BATCH_MAX) {
+    printf("test_spawn: at most %d processes per batch\n", SPAWN_BATCH_MAX);
+    return -1;
+  }
+
+  SpawnRequest *requests = myMalloc(sizeof(SpawnRequest) * count);
+  int32_t *pids = myMalloc(sizeof(int32_t) * count);
+  if (requests == NULL || pids == NULL) {
+    printf("test_spawn: ERROR allocating tables\n");
+    myFree(requests);
+    myFree(pids);
+    return -1;
+  }
+  for (int i = 0; i < count; i++) {
+    requests[i] = (SpawnRequest){
+        .function = (void *)idle_child,
+        .attributes = {.priority = SPAWN_INHERIT_PRIORITY, .is_background = 1},
+    };
+  }
+
+  uint64_t cycles_per_second = measure_cycles_per_second();
+
+  uint64_t single_cycles = 0, batch_cycles = 0;
+  int status = 0;
+  for (int round = 0; round < rounds && status == 0; round++) {
+    single_cycles += spawn_single(requests, pids, count);
+    for (int i = 0; i < count; i++) {
+      if (pids[i] < 0)
+        status = -1;
+    }
+    if (reap(pids, count) != 0)
+      status = -1;
+
+    batch_cycles += spawn_batch(requests, pids, count);
+    for (int i = 0; i < count; i++) {
+      if (pids[i] < 0)
+        status = -1;
+    }
+    if (reap(pids, count) != 0)
+      status = -1;
+  }
+
+  if (status != 0) {
+    printf("test_spawn: ERROR spawning %d processes\n", count);
+  } else {
+    int spawns = rounds * count;
+    printf("%d rounds of %d processes\n", rounds, count);
+    printf("single: %d cycles per spawn, ~%d spawns/s\n", (int)(single_cycles / spawns),
+           spawns_per_second(single_cycles, spawns, cycles_per_second));
+    printf("batch:  %d cycles per spawn, ~%d spawns/s\n", (int)(batch_cycles / spawns),
+           spawns_per_second(batch_cycles, spawns, cycles_per_second));
+  }
+
+  myFree(requests);
+  myFree(pids);
+  return status;
+}
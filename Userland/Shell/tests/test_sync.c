@@ -2,12 +2,37 @@
 #include <stdio.h>
 #include "test_util.h"
 #include "sys.h"
+#include "fastSemaphore.h"
 
 #define SEM_ID "sem"
 #define TOTAL_PAIR_PROCESSES 2
+#define USE_NO_SYNC 0
+#define USE_KERNEL_SEM 1
+#define USE_FAST_SEM 2    // Count in shared memory, the kernel is only entered to block or wake
+#define USE_MUTEX 3
 
 int64_t global; // shared memory
 void * sem;
+void * mutex;
+FastSemaphore fast_sem;
+
+static void lock(int8_t use_sem) {
+  if (use_sem == USE_KERNEL_SEM)
+    semWait(sem);
+  else if (use_sem == USE_FAST_SEM)
+    fastSemWait(&fast_sem);
+  else if (use_sem == USE_MUTEX)
+    mutexLock(mutex);
+}
+
+static void unlock(int8_t use_sem) {
+  if (use_sem == USE_KERNEL_SEM)
+    semPost(sem);
+  else if (use_sem == USE_FAST_SEM)
+    fastSemPost(&fast_sem);
+  else if (use_sem == USE_MUTEX)
+    mutexUnlock(mutex);
+}
 
 void slowInc(int64_t *p, int64_t inc) {
   uint64_t aux = *p;
@@ -33,9 +58,9 @@ uint64_t my_process_inc(uint64_t argc, char *argv[]) {
 
   uint64_t i;
   for (i = 0; i < n; i++) {
-    if (use_sem) semWait(sem);
+    lock(use_sem);
     slowInc(&global, inc);
-    if (use_sem) semPost(sem);
+    unlock(use_sem);
   }
   
   return 0;
@@ -50,14 +75,28 @@ uint64_t test_sync(uint64_t argc, char *argv[]) { //{n, use_sem, 0}
   char *argvDec[] = {argv[0], "-1", argv[1], NULL};
   char *argvInc[] = {argv[0], "1", argv[1], NULL};
 
-  int use_sem = satoi(argv[1]);
-  if(use_sem){
+  // One digit, satoi would also turn garbage into 0 and run unsynchronized
+  int use_sem = (argv[1][0] != '\0' && argv[1][1] == '\0') ? argv[1][0] - '0' : -1;
+  if (use_sem < USE_NO_SYNC || use_sem > USE_MUTEX) {
+    printf("Usage: test_sync <iterations> <use_semaphore:0|1|2|3>, 0 none, 1 kernel semaphore, 2 fast semaphore, 3 mutex\n");
+    return -1;
+  }
+  if (use_sem == USE_FAST_SEM)
+    fastSemInit(&fast_sem, 1);
+  if (use_sem == USE_KERNEL_SEM) {
     sem = semInit(SEM_ID, 1);
     if (sem == NULL) {
       printf("test_sync: ERROR opening semaphore\n");
       return -1;
     }
   }
+  if (use_sem == USE_MUTEX) {
+    mutex = mutexCreate(0);
+    if (mutex == NULL) {
+      printf("test_sync: ERROR creating mutex\n");
+      return -1;
+    }
+  }
 
   global = 0;
 
@@ -72,7 +111,8 @@ uint64_t test_sync(uint64_t argc, char *argv[]) { //{n, use_sem, 0}
     waitPid(pids[i + TOTAL_PAIR_PROCESSES]);
   }
 
-  if (use_sem) semDestroy(sem);
+  if (use_sem == USE_KERNEL_SEM) semDestroy(sem);
+  if (use_sem == USE_MUTEX) mutexDestroy(mutex);
 
   printf("Final value: %d\n", global);
 
@@ -0,0 +1,117 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "sys.h"
+#include "test_util.h"
+
+#define DEFAULT_WORKERS 8
+
+// Workers spin on this flag so every one of them is alive when memory is measured
+static volatile int release_workers = 0;
+
+static void thread_worker(void *arg) {
+  int *counter = (int *)arg;
+  while (!release_workers)
+    yield();
+  (*counter)++;
+}
+
+static uint64_t process_worker(uint64_t argc, char *argv[]) {
+  while (!release_workers)
+    yield();
+  return 0;
+}
+
+typedef struct {
+  uint64_t cycles;
+  int bytes;
+} spawn_cost;
+
+// Creates count workers as threads or processes and reports what creating them cost
+static int measure(int use_threads, int count, int32_t *ids, int *counters, spawn_cost *cost) {
+  MemoryStats before, after;
+  StackCacheStats stacks_before, stacks_after;
+  memExtended(&before);
+  stackCacheStats(&stacks_before);
+
+  uint64_t start = read_cycles();
+  for (int i = 0; i < count; i++) {
+    if (use_threads) {
+      ids[i] = threadCreate(thread_worker, &counters[i], 0);
+    } else {
+      ids[i] = createProcess((void *)process_worker, 0, NULL, 1);
+    }
+    if (ids[i] < 0) {
+      printf("test_threads: ERROR creating %s %d\n", use_threads ? "thread" : "process", i);
+      release_workers = 1;
+      for (int j = 0; j < i; j++)
+        use_threads ? threadJoin(ids[j]) : waitPid(ids[j]);
+      release_workers = 0;
+      return -1;
+    }
+  }
+  cost->cycles = read_cycles() - start;
+
+  memExtended(&after);
+  stackCacheStats(&stacks_after);
+
+  // Stacks taken from the stack cache were already counted as used, add them back
+  ProcessInformation info;
+  int reused = stacks_after.hits - stacks_before.hits;
+  cost->bytes = after.used - before.used;
+  if (reused > 0 && getProcessInfo(ids[0], &info) == 0)
+    cost->bytes += reused * info.stack_size;
+
+  release_workers = 1;
+  int status = 0;
+  for (int i = 0; i < count; i++) {
+    int result = use_threads ? threadJoin(ids[i]) : waitPid(ids[i]);
+    if (result != 0) {
+      printf("test_threads: ERROR waiting for %d\n", ids[i]);
+      status = -1;
+    }
+  }
+  release_workers = 0;
+  return status;
+}
+
+int64_t test_threads(uint64_t argc, char *argv[]) {
+  int count = DEFAULT_WORKERS;
+  if (argc > 1) {
+    count = satoi(argv[1]);
+    if (count <= 0) {
+      printf("test_threads: invalid worker count '%s'\n", argv[1]);
+      return -1;
+    }
+  }
+
+  int32_t *ids = myMalloc(sizeof(int32_t) * count);
+  int *counters = myCalloc(count, sizeof(int));
+  if (ids == NULL || counters == NULL) {
+    printf("test_threads: ERROR allocating tables\n");
+    myFree(ids);
+    myFree(counters);
+    return -1;
+  }
+
+  spawn_cost threads, processes;
+  int status = measure(1, count, ids, counters, &threads);
+  for (int i = 0; status == 0 && i < count; i++) {
+    if (counters[i] != 1) {
+      printf("test_threads: ERROR thread %d did not get its argument\n", i);
+      status = -1;
+    }
+  }
+  if (status == 0)
+    status = measure(0, count, ids, counters, &processes);
+
+  if (status == 0) {
+    printf("Created %d threads and %d processes\n", count, count);
+    printf("thread:  %d cycles, %d bytes each\n", (int)(threads.cycles / count), threads.bytes / count);
+    printf("process: %d cycles, %d bytes each\n", (int)(processes.cycles / count), processes.bytes / count);
+    printf("test_threads: OK\n");
+  }
+
+  myFree(ids);
+  myFree(counters);
+  return status;
+}
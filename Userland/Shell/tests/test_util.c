@@ -1,6 +1,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "syscall.h"
+#include "sys.h"
 
 // Random
 static uint32_t m_z = 362436069;
@@ -52,6 +53,22 @@ int64_t satoi(char *str) {
   return res * sign;
 }
 
+// Timing
+uint64_t read_cycles(void) {
+  uint32_t low, high;
+  __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+  return ((uint64_t)high << 32) | low;
+}
+
+#define CALIBRATION_MS 500
+
+// Measures the TSC rate against the timer so the benchmarks can report per-second figures
+uint64_t measure_cycles_per_second(void) {
+  uint64_t start = read_cycles();
+  sleep(CALIBRATION_MS);
+  return (read_cycles() - start) * 1000 / CALIBRATION_MS;
+}
+
 // Dummies
 void bussy_wait(uint64_t n) {
   uint64_t i;
@@ -4,6 +4,8 @@ uint32_t GetUint();
 uint32_t GetUniform(uint32_t max);
 uint8_t memcheck(void *start, uint8_t value, uint32_t size);
 int64_t satoi(char *str);
+uint64_t read_cycles(void);
+uint64_t measure_cycles_per_second(void);
 void *memset(void *destination, int32_t c, uint64_t length);
 void bussy_wait(uint64_t n);
 void endless_loop();
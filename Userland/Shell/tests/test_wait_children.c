@@ -4,6 +4,11 @@
 #include "sys.h"
 #include "test_util.h"
 
+// Each child exits with a status derived from its PID so the parent can check the pairing
+#define CHILD_STATUS(pid) ((pid) % 100)
+#define OVERFLOW_CHILDREN (PROCESS_MAX_ZOMBIES + 1)
+#define OVERFLOW_SETTLE_MS 200
+
 static uint64_t child_task(uint64_t argc, char *argv[]) {
     int pid = getPid();
     printf("wait_children child %d starting\n", pid);
@@ -14,6 +19,47 @@ static uint64_t child_task(uint64_t argc, char *argv[]) {
     }
 
     printf("wait_children child %d exiting\n", pid);
+    return CHILD_STATUS(pid);
+}
+
+static uint64_t quiet_child_task(uint64_t argc, char *argv[]) {
+    return CHILD_STATUS(getPid());
+}
+
+// Lets one child more than the parent keeps records for end unwaited: only the oldest record is dropped
+static int check_zombie_cap(void) {
+    int32_t pids[OVERFLOW_CHILDREN];
+    SpawnRequest *requests = myMalloc(sizeof(SpawnRequest) * OVERFLOW_CHILDREN);
+    if (requests == NULL) {
+        printf("test_wait_children: unable to allocate spawn requests\n");
+        return -1;
+    }
+    for (int i = 0; i < OVERFLOW_CHILDREN; i++) {
+        requests[i] = (SpawnRequest){
+            .function = (void *)quiet_child_task,
+            .attributes = {.priority = SPAWN_INHERIT_PRIORITY},
+        };
+    }
+    int spawned = spawnBatch(requests, OVERFLOW_CHILDREN, pids);
+    myFree(requests);
+    if (spawned != OVERFLOW_CHILDREN) {
+        printf("test_wait_children: failed to create the overflow children\n");
+        return -1;
+    }
+    sleep(OVERFLOW_SETTLE_MS);
+
+    int status;
+    if (waitPidStatus(pids[0], &status) != -1) {
+        printf("test_wait_children: the oldest of %d unwaited children kept its record\n", OVERFLOW_CHILDREN);
+        return -1;
+    }
+    for (int i = 1; i < OVERFLOW_CHILDREN; i++) {
+        if (waitPidStatus(pids[i], &status) != 0 || status != CHILD_STATUS(pids[i])) {
+            printf("test_wait_children: child %d lost its record within the cap\n", pids[i]);
+            return -1;
+        }
+    }
+    printf("wait_children kept the last %d of %d unwaited records\n", PROCESS_MAX_ZOMBIES, OVERFLOW_CHILDREN);
     return 0;
 }
 
@@ -31,19 +77,52 @@ uint64_t test_wait_children(uint64_t argc, char *argv[]) {
 
     printf("wait_children parent %d creating %d child processes\n", getPid(), child_count);
 
-    for (int i = 0; i < child_count; i++) {
-        int32_t pid = createProcess((void *)child_task, 0, NULL, 0);
-        if (pid < 0) {
-            printf("test_wait_children: failed to create child %d\n", i);
+    // Children are created SPAWN_BATCH_MAX at a time, the tables do not fit in the stack
+    int batch_size = child_count < SPAWN_BATCH_MAX ? child_count : SPAWN_BATCH_MAX;
+    SpawnRequest *requests = myMalloc(sizeof(SpawnRequest) * batch_size);
+    int32_t *pids = myMalloc(sizeof(int32_t) * batch_size);
+    if (requests == NULL || pids == NULL) {
+        printf("test_wait_children: unable to allocate spawn requests\n");
+        myFree(requests);
+        myFree(pids);
+        return -1;
+    }
+    for (int i = 0; i < batch_size; i++) {
+        requests[i] = (SpawnRequest){
+            .function = (void *)child_task,
+            .attributes = {.priority = SPAWN_INHERIT_PRIORITY},
+        };
+    }
+
+    for (int created = 0; created < child_count; created += batch_size) {
+        int batch = child_count - created < batch_size ? child_count - created : batch_size;
+        int spawned = spawnBatch(requests, batch, pids);
+        for (int i = 0; i < spawned; i++) {
+            printf("wait_children parent created child pid %d\n", pids[i]);
+        }
+        if (spawned != batch) {
+            printf("test_wait_children: failed to create child %d\n", created + (spawned < 0 ? 0 : spawned));
+            myFree(requests);
+            myFree(pids);
             return -1;
         }
-        printf("wait_children parent created child pid %d\n", pid);
     }
+    myFree(requests);
+    myFree(pids);
 
     printf("wait_children parent waiting for all children...\n");
-    if (waitChildren() != 0) {
-        printf("test_wait_children: waitChildren returned error\n");
-        return -1;
+    for (int reaped = 0; reaped < child_count; reaped++) {
+        int status;
+        int pid = waitAny(&status);
+        if (pid < 0) {
+            printf("test_wait_children: waitAny ran out of children after %d\n", reaped);
+            return -1;
+        }
+        if (status != CHILD_STATUS(pid)) {
+            printf("test_wait_children: child %d exited with %d, expected %d\n", pid, status, CHILD_STATUS(pid));
+            return -1;
+        }
+        printf("wait_children parent reaped child %d (status %d)\n", pid, status);
     }
 
     printf("wait_children parent resumed; all children finished\n");
@@ -54,6 +133,10 @@ uint64_t test_wait_children(uint64_t argc, char *argv[]) {
         return -1;
     }
 
+    if (check_zombie_cap() != 0) {
+        return -1;
+    }
+
     printf("wait_children test completed successfully\n");
     return 0;
 }
@@ -8,4 +8,11 @@ uint64_t test_prio(uint64_t argc, char *argv[]);
 int64_t test_processes(uint64_t argc, char *argv[]);
 uint64_t test_sync(uint64_t argc, char *argv[]);
 uint64_t test_wait_children(uint64_t argc, char *argv[]);
+int64_t test_threads(uint64_t argc, char *argv[]);
+int64_t test_spawn(uint64_t argc, char *argv[]);
+int64_t test_sem(uint64_t argc, char *argv[]);
+int64_t test_cond(uint64_t argc, char *argv[]);
+int64_t test_rwlock(uint64_t argc, char *argv[]);
+int64_t test_barrier(uint64_t argc, char *argv[]);
+int64_t test_pipe(uint64_t argc, char *argv[]);
 #endif // TESTS_H
@@ -0,0 +1,20 @@
+#ifndef _FAST_SEMAPHORE_H_
+#define _FAST_SEMAPHORE_H_
+
+#include <stdint.h>
+
+// Semaphore whose count lives in the caller's memory. Waits and posts that do not have to block or wake
+// anyone are a single atomic instruction, the kernel is only entered through futexWait and futexWake.
+// Every process using it must see the same structure, a global or memory handed to its children works.
+typedef struct FastSemaphore {
+    volatile int32_t count;
+    volatile int32_t waiters;   // Processes inside fastSemWait that found no token
+} FastSemaphore;
+
+void fastSemInit(FastSemaphore * sem, int32_t count);
+void fastSemWait(FastSemaphore * sem);
+// Takes a token if there is one without blocking, returns 1 when it did
+int fastSemTryWait(FastSemaphore * sem);
+void fastSemPost(FastSemaphore * sem);
+
+#endif
@@ -33,26 +33,101 @@ int32_t getCharacterWithoutDisplay(void);
 void * myMalloc(int size);
 int32_t myFree(void * ptr);
 int32_t mem(int * total, int * used, int * available);
+int32_t memByPid(int pid);
+int32_t memExtended(MemoryStats * stats);
+void * myRealloc(void * ptr, int size);
+void * myCalloc(int count, int size);
+void * myAlignedAlloc(int alignment, int size);
+int32_t stackCacheStats(StackCacheStats * stats);
 
 int32_t getPid(void);
 int32_t createProcess(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background);
+int32_t createProcessWithStack(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background, int stackSize);
+// Creates a process with its fds set by the attributes' file actions, without touching the caller's fds
+int32_t spawnProcess(void * function, int argc, char ** argv, const SpawnAttributes * attributes);
+// Spawns up to SPAWN_BATCH_MAX processes in one syscall, returns how many were created (the rest get pid -1)
+int32_t spawnBatch(const SpawnRequest * requests, int count, int32_t * pids);
 int32_t unblock(int pid);
 int32_t block(int pid);
 int32_t kill(int pid);
 int32_t nice(int pid, int newPriority);
+// Only the last PROCESS_MAX_ZOMBIES children that ended without being waited for keep their exit record.
+// Waiting for an older one returns -1, as if it had already been waited for.
 int32_t waitPid(int pid);
+// Like waitPid, also storing the value the child's entry function returned (-1 if it was killed)
+int32_t waitPidStatus(int pid, int * status);
+// Waits for whichever child finishes first and returns its PID, -1 when there are no children left
+int32_t waitAny(int * status);
 int32_t getProcessInfo(int pid, ProcessInformation *info);
 int32_t waitChildren(void);
-int32_t ps(ProcessInformation * processInfoTable);
+int32_t ps(ProcessInformation * processInfoTable, int maxCount);
+// Copies the process table in one pass. With since set to a previous snapshot's generation only the processes
+// that changed are copied, unless snapshot->full says the kernel no longer knew and sent them all.
+// Apply snapshot->removed before the entries, a removed PID may already belong to a new process.
+int32_t processSnapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot);
+// Caps a resource of a process and of the children it creates afterwards, RESOURCE_UNLIMITED removes the cap
+int32_t setResourceLimit(int pid, ResourceType type, int limit);
+int32_t getResourceUsage(int pid, ResourceUsage * resources);
 int32_t yield(void);
+// Threads share the fds, children and heap accounting of their process, stackSize 0 uses the default
+int32_t threadCreate(void (*function)(void * arg), void * arg, int stackSize);
+int32_t threadJoin(int tid);
 
+// Opens the named semaphore, initial_count only matters when it does not exist yet
 void * semInit(const char *name, uint32_t initial_count);
 int32_t semPost(void * sem);
 int32_t semWait(void * sem);
+// Closes one semInit, the semaphore is destroyed with the last one
 int32_t semDestroy(void * sem);
+// Sleeps while *addr == expected, returns 1 without sleeping if it already changed
+int32_t futexWait(int32_t * addr, int32_t expected);
+// Wakes up to count processes sleeping on addr
+int32_t futexWake(int32_t * addr, int count);
+
+// Owner-tracked mutex, a recursive one can be relocked by its owner. Only the owner can unlock.
+void * mutexCreate(uint8_t recursive);
+int32_t mutexLock(void * mutex);
+// Returns 1 instead of blocking when another process owns the mutex
+int32_t mutexTryLock(void * mutex);
+int32_t mutexUnlock(void * mutex);
+// Fails while the mutex is locked or waited on
+int32_t mutexDestroy(void * mutex);
+void * condCreate(void);
+// Releases the mutex, sleeps until signalled and returns owning it again
+int32_t condWait(void * cond, void * mutex);
+int32_t condSignal(void * cond);
+// Moves every waiter to the mutex queue, they run one at a time as the mutex is handed over
+int32_t condBroadcast(void * cond);
+// Fails while processes wait on the condition
+int32_t condDestroy(void * cond);
+// Reader-writer lock: waiting writers hold off new readers, and the readers queued meanwhile enter together
+void * rwlockCreate(void);
+int32_t rwlockReadLock(void * lock);
+int32_t rwlockWriteLock(void * lock);
+// Releases whichever side the caller holds
+int32_t rwlockUnlock(void * lock);
+// Fails while the lock is held or waited on
+int32_t rwlockDestroy(void * lock);
+// Reusable barrier for parties processes, the last to arrive gets 1 and releases the rest at once
+void * barrierCreate(int parties);
+int32_t barrierWait(void * barrier);
+int32_t barrierDestroy(void * barrier);
+// One-shot latch: latchWait sleeps until latchCountDown brings the count to zero
+void * latchCreate(int count);
+// Returns the count left
+int32_t latchCountDown(void * latch, int count);
+int32_t latchWait(void * latch);
+int32_t latchDestroy(void * latch);
+// Lock contention entries sorted by total wait, -1 when the kernel was built without LOCK_STATS=1
+int32_t lockStats(LockStatsEntry * table, int maxCount);
 
 int32_t openPipe(int pipefd[2]);
 int32_t closePipe(int pipeID);
 int32_t setFdTarget(int fd, int type, int pipeID);
+// Lends buf to the pipe behind fd instead of copying it, returns once readers consumed it
+int32_t vmsplice(int fd, const char * buf, int count);
+// Moves up to count bytes from the stdin pipe to stdout without passing them through the caller, -1 when stdin
+// is not a pipe. Output to the console moves 512 bytes per call at most
+int32_t splice(int fdIn, int fdOut, int count);
 
 #endif
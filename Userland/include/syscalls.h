@@ -5,6 +5,9 @@
 #include <stddef.h>
 
 #define PROCESS_NAME_MAX_LENGTH 64
+#define PROCESS_STACK_MIN_SIZE 4096   // Stack size hints are rounded up to a power of two in this range
+#define PROCESS_STACK_MAX_SIZE 16384
+#define PROCESS_MAX_ZOMBIES 32      // Exit records a process keeps for children it has not waited for yet
 
 // Enum of registerable keys.
 // Note: Does not include TAB or RETURN
@@ -150,12 +153,55 @@ int32_t sys_get_character_without_display(void);
 
 
 // ================== Memory management syscall prototypes =================
+#define MEMORY_STATS_CLASSES 16
+#define MEMORY_STATS_MIN_CLASS_SIZE 32
+
+typedef struct MemoryStats {
+    int total;
+    int used;
+    int available;
+    int largestFreeBlock;
+    int internalFragmentation;
+    uint32_t allocationCount;
+    uint32_t freeCount;
+    uint32_t failedCount;
+    uint64_t maxMallocCycles;
+    uint64_t maxFreeCycles;
+    uint64_t mallocCycles;
+    uint64_t freeCycles;
+    uint32_t freeBlocks[MEMORY_STATS_CLASSES];
+    uint32_t requestSizes[MEMORY_STATS_CLASSES];
+} MemoryStats;
+
 /* 0x80000100 */
 void * sys_malloc(int size);
 /* 0x80000101 */
 int32_t sys_free(void * ptr);
 /* 0x80000102 */
 int32_t sys_memstats(int * total, int * used, int * available);
+/* 0x80000103 */
+int32_t sys_memstats_pid(int pid);
+/* 0x80000104 */
+int32_t sys_memstats_extended(MemoryStats * stats);
+/* 0x80000105 */
+void * sys_realloc(void * ptr, int size);
+/* 0x80000106 */
+void * sys_calloc(int count, int size);
+/* 0x80000107 */
+void * sys_aligned_alloc(int alignment, int size);
+
+typedef struct StackCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t released;
+    uint32_t cached;
+    uint32_t highWater;
+    uint32_t peakUsage;
+    uint32_t exhausted;
+} StackCacheStats;
+
+/* 0x80000108 */
+int32_t sys_stack_cache_stats(StackCacheStats * stats);
 // =========================================================================
 
 // ================== Process management syscall prototypes =================
@@ -166,6 +212,21 @@ typedef enum ProcessState {
     PROCESS_STATE_TERMINATED
 } ProcessState;
 
+typedef enum {
+    RESOURCE_HEAP = 0,
+    RESOURCE_STACK,
+    RESOURCE_PIPES,
+    RESOURCE_SEMAPHORES,
+    RESOURCE_COUNT
+} ResourceType;
+
+#define RESOURCE_UNLIMITED -1
+
+typedef struct ResourceUsage {
+    int usage[RESOURCE_COUNT];
+    int limits[RESOURCE_COUNT];
+} ResourceUsage;
+
 typedef struct ProcessInformation{
     int pid;
     char name[PROCESS_NAME_MAX_LENGTH];
@@ -174,12 +235,26 @@ typedef struct ProcessInformation{
     uint8_t * rsp;
     uint8_t * stack_base;
     uint8_t is_foreground;
+    int stack_size;
+    int stack_used;
+    ResourceUsage resources;
 } ProcessInformation;
 
+#define PROCESS_SNAPSHOT_REMOVED_MAX 32
+
+typedef struct ProcessSnapshot {
+    uint64_t generation;
+    int count;
+    int total;
+    uint8_t full;
+    int removedCount;
+    int removed[PROCESS_SNAPSHOT_REMOVED_MAX];
+} ProcessSnapshot;
+
 /* 0x80000200 */
 int32_t sys_getpid(void);
 /* 0x80000201 */
-int32_t sys_create_process(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background);
+int32_t sys_create_process(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background, int stackSize);
 /* 0x80000202 */
 int32_t sys_unblock(int pid);
 /* 0x80000203 */
@@ -187,21 +262,85 @@ int32_t sys_block(int pid);
 /* 0x80000204 */
 int32_t sys_kill(int pid);
 /* 0x80000205 */
-int32_t sys_ps(ProcessInformation * processInfoTable);
+int32_t sys_ps(ProcessInformation * processInfoTable, int maxCount);
 /* 0x80000206 */
 int32_t sys_nice(int pid, int newPriority);
 /* 0x80000207 */
-int32_t sys_wait_pid(int pid);
+int32_t sys_wait_pid(int pid, int * status);
 /* 0x80000208 */
 int32_t sys_yield(void);
 /* 0x80000209 */
 int32_t sys_wait_children(void);
 /* 0x8000020A */
 int32_t sys_get_process_info(int pid, ProcessInformation *info);
+/* 0x8000020B */
+int32_t sys_thread_create(void * function, void * arg, int stackSize);
+/* 0x8000020C */
+int32_t sys_thread_join(int tid);
+
+#define SPAWN_MAX_FILE_ACTIONS 2
+#define SPAWN_INHERIT_PRIORITY -1
+
+typedef struct SpawnFileAction {
+    int fd;
+    int type;       // PIPE_ENDPOINT_*
+    int pipeID;
+} SpawnFileAction;
+
+typedef struct SpawnAttributes {
+    SpawnFileAction actions[SPAWN_MAX_FILE_ACTIONS];
+    int actionCount;
+    int priority;
+    uint8_t is_background;
+    int stackSize;
+} SpawnAttributes;
+
+/* 0x8000020D */
+int32_t sys_spawn(void * function, int argc, char ** argv, const SpawnAttributes * attributes);
+
+#define SPAWN_BATCH_MAX 64
+
+typedef struct SpawnRequest {
+    void * function;
+    int argc;
+    char ** argv;
+    SpawnAttributes attributes;
+} SpawnRequest;
+
+/* 0x8000020E */
+int32_t sys_spawn_batch(const SpawnRequest * requests, int count, int32_t * pids);
+/* 0x8000020F */
+int32_t sys_wait_any(int * status);
+/* 0x80000210 */
+int32_t sys_process_snapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot);
+/* 0x80000211 */
+int32_t sys_set_resource_limit(int pid, ResourceType type, int limit);
+/* 0x80000212 */
+int32_t sys_get_resource_usage(int pid, ResourceUsage * resources);
 // ==========================================================================
 
 // ================== Semaphore management syscall prototypes =================
 
+#define LOCK_STATS_MAX 64
+#define LOCK_STATS_NAME_LENGTH 16
+
+typedef enum {
+    LOCK_KIND_SPINLOCK = 0,
+    LOCK_KIND_SEMAPHORE,
+} LockKind;
+
+typedef struct LockStatsEntry {
+    uint64_t address;
+    char name[LOCK_STATS_NAME_LENGTH];
+    uint8_t kind;
+    int holderPid;
+    uint64_t acquisitions;
+    uint64_t contended;
+    uint64_t spins;
+    uint64_t waitCycles;
+    uint64_t maxWaitCycles;
+} LockStatsEntry;
+
 /* 0x80000300 */
 void * sys_sem_init(const char *name, uint32_t initial_count);
 /* 0x80000301 */
@@ -210,6 +349,56 @@ int32_t sys_sem_post(void * sem);
 int32_t sys_sem_wait(void * sem);
 /* 0x80000303 */
 int32_t sys_sem_destroy(void * sem);
+/* 0x80000304 */
+int32_t sys_futex_wait(int32_t * addr, int32_t expected);
+/* 0x80000305 */
+int32_t sys_futex_wake(int32_t * addr, int count);
+/* 0x80000306 */
+void * sys_mutex_create(uint8_t recursive);
+/* 0x80000307 */
+int32_t sys_mutex_lock(void * mutex);
+/* 0x80000308 */
+int32_t sys_mutex_trylock(void * mutex);
+/* 0x80000309 */
+int32_t sys_mutex_unlock(void * mutex);
+/* 0x8000030A */
+int32_t sys_mutex_destroy(void * mutex);
+/* 0x8000030B */
+void * sys_cond_create(void);
+/* 0x8000030C */
+int32_t sys_cond_wait(void * cond, void * mutex);
+/* 0x8000030D */
+int32_t sys_cond_signal(void * cond);
+/* 0x8000030E */
+int32_t sys_cond_broadcast(void * cond);
+/* 0x8000030F */
+int32_t sys_cond_destroy(void * cond);
+/* 0x80000310 */
+void * sys_rwlock_create(void);
+/* 0x80000311 */
+int32_t sys_rwlock_read_lock(void * lock);
+/* 0x80000312 */
+int32_t sys_rwlock_write_lock(void * lock);
+/* 0x80000313 */
+int32_t sys_rwlock_unlock(void * lock);
+/* 0x80000314 */
+int32_t sys_rwlock_destroy(void * lock);
+/* 0x80000315 */
+void * sys_barrier_create(int parties);
+/* 0x80000316 */
+int32_t sys_barrier_wait(void * barrier);
+/* 0x80000317 */
+int32_t sys_barrier_destroy(void * barrier);
+/* 0x80000318 */
+void * sys_latch_create(int count);
+/* 0x80000319 */
+int32_t sys_latch_count_down(void * latch, int count);
+/* 0x8000031A */
+int32_t sys_latch_wait(void * latch);
+/* 0x8000031B */
+int32_t sys_latch_destroy(void * latch);
+/* 0x8000031C */
+int32_t sys_lock_stats(LockStatsEntry * table, int maxCount);
 
 #define PIPE_ENDPOINT_NONE 0
 #define PIPE_ENDPOINT_CONSOLE 1
@@ -225,5 +414,9 @@ int32_t sys_pipe(int pipefd[2]);
 int32_t sys_close_pipe(int pipeID);
 /* 0x80000402 */
 int32_t sys_set_fd_target(int fd, int type, int pipeID);
+/* 0x80000403 */
+int32_t sys_vmsplice(int32_t fd, const char * buf, int32_t count);
+/* 0x80000404 */
+int32_t sys_splice(int32_t fdIn, int32_t fdOut, int32_t count);
 
 #endif
@@ -32,6 +32,12 @@ GLOBAL sys_get_character_without_display
 GLOBAL sys_malloc
 GLOBAL sys_free
 GLOBAL sys_memstats
+GLOBAL sys_memstats_pid
+GLOBAL sys_memstats_extended
+GLOBAL sys_realloc
+GLOBAL sys_calloc
+GLOBAL sys_aligned_alloc
+GLOBAL sys_stack_cache_stats
 
 GLOBAL sys_getpid
 GLOBAL sys_create_process
@@ -45,14 +51,49 @@ GLOBAL sys_wait_pid
 GLOBAL sys_yield
 GLOBAL sys_wait_children
 GLOBAL sys_get_process_info
+GLOBAL sys_thread_create
+GLOBAL sys_thread_join
+GLOBAL sys_spawn
+GLOBAL sys_spawn_batch
+GLOBAL sys_wait_any
+GLOBAL sys_process_snapshot
+GLOBAL sys_set_resource_limit
+GLOBAL sys_get_resource_usage
 GLOBAL sys_sem_init
 GLOBAL sys_sem_post
 GLOBAL sys_sem_wait
 GLOBAL sys_sem_destroy
+GLOBAL sys_futex_wait
+GLOBAL sys_futex_wake
+GLOBAL sys_mutex_create
+GLOBAL sys_mutex_lock
+GLOBAL sys_mutex_trylock
+GLOBAL sys_mutex_unlock
+GLOBAL sys_mutex_destroy
+GLOBAL sys_cond_create
+GLOBAL sys_cond_wait
+GLOBAL sys_cond_signal
+GLOBAL sys_cond_broadcast
+GLOBAL sys_cond_destroy
+GLOBAL sys_rwlock_create
+GLOBAL sys_rwlock_read_lock
+GLOBAL sys_rwlock_write_lock
+GLOBAL sys_rwlock_unlock
+GLOBAL sys_rwlock_destroy
+GLOBAL sys_barrier_create
+GLOBAL sys_barrier_wait
+GLOBAL sys_barrier_destroy
+GLOBAL sys_latch_create
+GLOBAL sys_latch_count_down
+GLOBAL sys_latch_wait
+GLOBAL sys_latch_destroy
+GLOBAL sys_lock_stats
 
 GLOBAL sys_pipe
 GLOBAL sys_close_pipe
 GLOBAL sys_set_fd_target
+GLOBAL sys_vmsplice
+GLOBAL sys_splice
 section .text
 
 %macro sys_int80 1
@@ -103,6 +144,12 @@ sys_get_character_without_display: sys_int80 0x800000F0
 sys_malloc: sys_int80 0x80000100
 sys_free: sys_int80 0x80000101
 sys_memstats: sys_int80 0x80000102
+sys_memstats_pid: sys_int80 0x80000103
+sys_memstats_extended: sys_int80 0x80000104
+sys_realloc: sys_int80 0x80000105
+sys_calloc: sys_int80 0x80000106
+sys_aligned_alloc: sys_int80 0x80000107
+sys_stack_cache_stats: sys_int80 0x80000108
 
 sys_getpid: sys_int80 0x80000200
 sys_create_process: sys_int80 0x80000201
@@ -116,11 +163,46 @@ sys_wait_pid: sys_int80 0x80000207
 sys_yield: sys_int80 0x80000208
 sys_wait_children: sys_int80 0x80000209
 sys_get_process_info: sys_int80 0x8000020A
+sys_thread_create: sys_int80 0x8000020B
+sys_thread_join: sys_int80 0x8000020C
+sys_spawn: sys_int80 0x8000020D
+sys_spawn_batch: sys_int80 0x8000020E
+sys_wait_any: sys_int80 0x8000020F
+sys_process_snapshot: sys_int80 0x80000210
+sys_set_resource_limit: sys_int80 0x80000211
+sys_get_resource_usage: sys_int80 0x80000212
 
 sys_sem_init: sys_int80 0x80000300
 sys_sem_post: sys_int80 0x80000301
 sys_sem_wait: sys_int80 0x80000302
 sys_sem_destroy: sys_int80 0x80000303
+sys_futex_wait: sys_int80 0x80000304
+sys_futex_wake: sys_int80 0x80000305
+sys_mutex_create: sys_int80 0x80000306
+sys_mutex_lock: sys_int80 0x80000307
+sys_mutex_trylock: sys_int80 0x80000308
+sys_mutex_unlock: sys_int80 0x80000309
+sys_mutex_destroy: sys_int80 0x8000030A
+sys_cond_create: sys_int80 0x8000030B
+sys_cond_wait: sys_int80 0x8000030C
+sys_cond_signal: sys_int80 0x8000030D
+sys_cond_broadcast: sys_int80 0x8000030E
+sys_cond_destroy: sys_int80 0x8000030F
+sys_rwlock_create: sys_int80 0x80000310
+sys_rwlock_read_lock: sys_int80 0x80000311
+sys_rwlock_write_lock: sys_int80 0x80000312
+sys_rwlock_unlock: sys_int80 0x80000313
+sys_rwlock_destroy: sys_int80 0x80000314
+sys_barrier_create: sys_int80 0x80000315
+sys_barrier_wait: sys_int80 0x80000316
+sys_barrier_destroy: sys_int80 0x80000317
+sys_latch_create: sys_int80 0x80000318
+sys_latch_count_down: sys_int80 0x80000319
+sys_latch_wait: sys_int80 0x8000031A
+sys_latch_destroy: sys_int80 0x8000031B
+sys_lock_stats: sys_int80 0x8000031C
 sys_pipe: sys_int80 0x80000400
 sys_close_pipe: sys_int80 0x80000401
 sys_set_fd_target: sys_int80 0x80000402
+sys_vmsplice: sys_int80 0x80000403
+sys_splice: sys_int80 0x80000404
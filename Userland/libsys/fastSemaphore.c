@@ -0,0 +1,33 @@
+#include <fastSemaphore.h>
+#include <sys.h>
+
+void fastSemInit(FastSemaphore * sem, int32_t count) {
+    sem->count = count;
+    sem->waiters = 0;
+}
+
+int fastSemTryWait(FastSemaphore * sem) {
+    int32_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+    while (count > 0) {
+        if (__atomic_compare_exchange_n(&sem->count, &count, count - 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void fastSemWait(FastSemaphore * sem) {
+    while (!fastSemTryWait(sem)) {
+        __atomic_add_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+        // Returns at once if a post raised the count after the failed attempt, so no wake is missed
+        futexWait((int32_t *)&sem->count, 0);
+        __atomic_sub_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void fastSemPost(FastSemaphore * sem) {
+    __atomic_add_fetch(&sem->count, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0) {
+        futexWake((int32_t *)&sem->count, 1);
+    }
+}
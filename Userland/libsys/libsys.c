@@ -98,6 +98,30 @@ int32_t myFree(void * ptr){
 int32_t mem(int * total, int * used, int * available){
     return sys_memstats(total, used, available) ;
 }
+/* 0x80000103 */
+int32_t memByPid(int pid){
+    return sys_memstats_pid(pid);
+}
+/* 0x80000104 */
+int32_t memExtended(MemoryStats * stats){
+    return sys_memstats_extended(stats);
+}
+/* 0x80000105 */
+void * myRealloc(void * ptr, int size){
+    return sys_realloc(ptr, size);
+}
+/* 0x80000106 */
+void * myCalloc(int count, int size){
+    return sys_calloc(count, size);
+}
+/* 0x80000107 */
+void * myAlignedAlloc(int alignment, int size){
+    return sys_aligned_alloc(alignment, size);
+}
+/* 0x80000108 */
+int32_t stackCacheStats(StackCacheStats * stats){
+    return sys_stack_cache_stats(stats);
+}
 
 // Process management syscall prototypes
 /* 0x80000200 */
@@ -106,7 +130,10 @@ int32_t getPid(void){
 }
 /* 0x80000201 */
 int32_t createProcess(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background){
-    return sys_create_process(function, argc, argv, is_background);
+    return sys_create_process(function, argc, argv, is_background, 0);
+}
+int32_t createProcessWithStack(void * function, uint64_t argc, uint8_t ** argv, uint8_t is_background, int stackSize){
+    return sys_create_process(function, argc, argv, is_background, stackSize);
 }
 /* 0x80000202 */
 int32_t unblock(int pid){
@@ -120,8 +147,8 @@ int32_t block(int pid){
 int32_t kill(int pid){
     return sys_kill(pid);
 }
-int32_t ps(ProcessInformation * processInfoTable){
-    return sys_ps(processInfoTable);
+int32_t ps(ProcessInformation * processInfoTable, int maxCount){
+    return sys_ps(processInfoTable, maxCount);
 }
 /* 0x80000206 */
 int32_t nice(int pid, int newPriority){
@@ -129,7 +156,10 @@ int32_t nice(int pid, int newPriority){
 }
 /* 0x80000207 */
 int32_t waitPid(int pid){
-    return sys_wait_pid(pid);
+    return sys_wait_pid(pid, NULL);
+}
+int32_t waitPidStatus(int pid, int * status){
+    return sys_wait_pid(pid, status);
 }
 /* 0x80000208 */
 int32_t yield(void){
@@ -143,6 +173,38 @@ int32_t waitChildren(void){
 int32_t getProcessInfo(int pid, ProcessInformation *info){
     return sys_get_process_info(pid, info);
 }
+/* 0x8000020B */
+int32_t threadCreate(void (*function)(void * arg), void * arg, int stackSize){
+    return sys_thread_create((void *) function, arg, stackSize);
+}
+/* 0x8000020C */
+int32_t threadJoin(int tid){
+    return sys_thread_join(tid);
+}
+/* 0x8000020D */
+int32_t spawnProcess(void * function, int argc, char ** argv, const SpawnAttributes * attributes){
+    return sys_spawn(function, argc, argv, attributes);
+}
+/* 0x8000020E */
+int32_t spawnBatch(const SpawnRequest * requests, int count, int32_t * pids){
+    return sys_spawn_batch(requests, count, pids);
+}
+/* 0x8000020F */
+int32_t waitAny(int * status){
+    return sys_wait_any(status);
+}
+/* 0x80000210 */
+int32_t processSnapshot(uint64_t since, ProcessInformation * table, int maxCount, ProcessSnapshot * snapshot){
+    return sys_process_snapshot(since, table, maxCount, snapshot);
+}
+/* 0x80000211 */
+int32_t setResourceLimit(int pid, ResourceType type, int limit){
+    return sys_set_resource_limit(pid, type, limit);
+}
+/* 0x80000212 */
+int32_t getResourceUsage(int pid, ResourceUsage * resources){
+    return sys_get_resource_usage(pid, resources);
+}
 
 // Semaphore management syscall prototypes
 /* 0x80000300 */
@@ -161,6 +223,106 @@ int32_t semWait(void * sem){
 int32_t semDestroy(void * sem){
     return sys_sem_destroy(sem);
 }
+/* 0x80000304 */
+int32_t futexWait(int32_t * addr, int32_t expected){
+    return sys_futex_wait(addr, expected);
+}
+/* 0x80000305 */
+int32_t futexWake(int32_t * addr, int count){
+    return sys_futex_wake(addr, count);
+}
+/* 0x80000306 */
+void * mutexCreate(uint8_t recursive){
+    return (void *)sys_mutex_create(recursive);
+}
+/* 0x80000307 */
+int32_t mutexLock(void * mutex){
+    return sys_mutex_lock(mutex);
+}
+/* 0x80000308 */
+int32_t mutexTryLock(void * mutex){
+    return sys_mutex_trylock(mutex);
+}
+/* 0x80000309 */
+int32_t mutexUnlock(void * mutex){
+    return sys_mutex_unlock(mutex);
+}
+/* 0x8000030A */
+int32_t mutexDestroy(void * mutex){
+    return sys_mutex_destroy(mutex);
+}
+/* 0x8000030B */
+void * condCreate(void){
+    return (void *)sys_cond_create();
+}
+/* 0x8000030C */
+int32_t condWait(void * cond, void * mutex){
+    return sys_cond_wait(cond, mutex);
+}
+/* 0x8000030D */
+int32_t condSignal(void * cond){
+    return sys_cond_signal(cond);
+}
+/* 0x8000030E */
+int32_t condBroadcast(void * cond){
+    return sys_cond_broadcast(cond);
+}
+/* 0x8000030F */
+int32_t condDestroy(void * cond){
+    return sys_cond_destroy(cond);
+}
+/* 0x80000310 */
+void * rwlockCreate(void){
+    return (void *)sys_rwlock_create();
+}
+/* 0x80000311 */
+int32_t rwlockReadLock(void * lock){
+    return sys_rwlock_read_lock(lock);
+}
+/* 0x80000312 */
+int32_t rwlockWriteLock(void * lock){
+    return sys_rwlock_write_lock(lock);
+}
+/* 0x80000313 */
+int32_t rwlockUnlock(void * lock){
+    return sys_rwlock_unlock(lock);
+}
+/* 0x80000314 */
+int32_t rwlockDestroy(void * lock){
+    return sys_rwlock_destroy(lock);
+}
+/* 0x80000315 */
+void * barrierCreate(int parties){
+    return (void *)sys_barrier_create(parties);
+}
+/* 0x80000316 */
+int32_t barrierWait(void * barrier){
+    return sys_barrier_wait(barrier);
+}
+/* 0x80000317 */
+int32_t barrierDestroy(void * barrier){
+    return sys_barrier_destroy(barrier);
+}
+/* 0x80000318 */
+void * latchCreate(int count){
+    return (void *)sys_latch_create(count);
+}
+/* 0x80000319 */
+int32_t latchCountDown(void * latch, int count){
+    return sys_latch_count_down(latch, count);
+}
+/* 0x8000031A */
+int32_t latchWait(void * latch){
+    return sys_latch_wait(latch);
+}
+/* 0x8000031B */
+int32_t latchDestroy(void * latch){
+    return sys_latch_destroy(latch);
+}
+/* 0x8000031C */
+int32_t lockStats(LockStatsEntry * table, int maxCount){
+    return sys_lock_stats(table, maxCount);
+}
 
 // Pipe management syscall prototypes
 /* 0x80000400 */
@@ -175,3 +337,11 @@ int32_t closePipe(int pipeID){
 int32_t setFdTarget(int fd, int type, int pipeID){
     return sys_set_fd_target(fd, type, pipeID);
 }
+/* 0x80000403 */
+int32_t vmsplice(int fd, const char * buf, int count){
+    return sys_vmsplice(fd, buf, count);
+}
+/* 0x80000404 */
+int32_t splice(int fdIn, int fdOut, int count){
+    return sys_splice(fdIn, fdOut, count);
+}
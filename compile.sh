@@ -4,8 +4,8 @@ CONTAINER_NAME="TP2-SO"
 # Memory allocator selection (default: buddy)
 ALLOCATOR="${1:-buddy}"
 
-if [ "$ALLOCATOR" != "buddy" ] && [ "$ALLOCATOR" != "bitmap" ]; then
-    echo "${RED}Invalid allocator. Use 'buddy' or 'bitmap'. Defaulting to 'buddy'.${NC}"
+if [ "$ALLOCATOR" != "buddy" ] && [ "$ALLOCATOR" != "bitmap" ] && [ "$ALLOCATOR" != "tlsf" ]; then
+    echo "${RED}Invalid allocator. Use 'buddy', 'bitmap' or 'tlsf'. Defaulting to 'buddy'.${NC}"
     ALLOCATOR="buddy"
 fi
 
@@ -64,7 +64,7 @@ if [ $DO_PVS -eq 0 ]; then
   echo "${YELLOW}Compiling with ${ALLOCATOR} memory allocator...${NC}"
   docker exec -it "$CONTAINER_NAME" make clean -C /root/ && \
   docker exec -it "$CONTAINER_NAME" make all -C /root/Toolchain && \
-  docker exec -it "$CONTAINER_NAME" make all -C /root/ ALLOCATOR="$ALLOCATOR"
+  docker exec -it "$CONTAINER_NAME" make all -C /root/ ALLOCATOR="$ALLOCATOR" MEMORY_TRACE="${MEMORY_TRACE:-0}" LOCK_STATS="${LOCK_STATS:-0}" STACK_CACHE_HIGH_WATER="${STACK_CACHE_HIGH_WATER:-}" STACK_CACHE_PREFILL="${STACK_CACHE_PREFILL:-}"
 else
   echo "${YELLOW}Running build under PVS-Studio trace with ${ALLOCATOR} memory allocator...${NC}"
   docker exec -it "$CONTAINER_NAME" bash -lc '
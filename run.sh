@@ -50,12 +50,19 @@ case $OS in
         ;;
 esac
 
+# Con MEMTRACE=archivo se guarda la traza de malloc/free (compilar con MEMORY_TRACE=1)
+TRACE_CONFIG=""
+if [ -n "$MEMTRACE" ]; then
+    TRACE_CONFIG="-debugcon file:$MEMTRACE"
+    echo "Guardando traza de memoria en $MEMTRACE"
+fi
+
 # Ejecutar QEMU con la configuración adecuada
-echo "Ejecutando: qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512 $AUDIO_CONFIG"
-qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512 $AUDIO_CONFIG
+echo "Ejecutando: qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512 $AUDIO_CONFIG $TRACE_CONFIG"
+qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512 $AUDIO_CONFIG $TRACE_CONFIG
 
 # Si lo anterior falla, probar estas alternativas:
 if [ $? -ne 0 ] && [ $IS_WSL -eq 1 ]; then
     echo "Error con la configuración de audio. Probando alternativa sin audio específico..."
-    qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512
+    qemu-system-x86_64 -hda Image/x64BareBonesImage.qcow2 -m 512 $TRACE_CONFIG
 fi